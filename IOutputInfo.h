@@ -0,0 +1,191 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_IOUTPUTINFO_H_
+#define _INCLUDE_OUTPUTINFO_IOUTPUTINFO_H_
+
+/**
+ * @file IOutputInfo.h
+ * @brief Interface for other extensions to read and edit entity output actions.
+ *
+ * Get it from the extension with:
+ *
+ *   IOutputInfo *g_pOutputInfo;
+ *   sharesys->RequestInterface(SMINTERFACE_OUTPUTINFO_NAME, SMINTERFACE_OUTPUTINFO_VERSION, myself, (SMInterface **)&g_pOutputInfo);
+ *
+ * The game's output and action types stay opaque; every access goes through
+ * the interface, so callers never depend on their layout.
+ */
+
+#include <IShareSys.h>
+
+#define SMINTERFACE_OUTPUTINFO_NAME		"IOutputInfo"
+#define SMINTERFACE_OUTPUTINFO_VERSION	1
+
+class CBaseEntity;
+class CBaseEntityOutput;
+class CEventAction;
+
+/**
+ * @brief Fields of an action. Strings read from an action are owned by the
+ * game's string pool and stay valid until the map ends.
+ */
+struct OutputActionData
+{
+	const char *target;			/**< Name of the entity(s) to cause the action in */
+	const char *targetInput;	/**< Name of the input to fire */
+	const char *parameter;		/**< Parameter to send, empty if none */
+	float delay;				/**< Seconds to wait before firing the action */
+	int timesToFire;			/**< Times left to fire, -1 for always */
+};
+
+class IOutputInfo : public SourceMod::SMInterface
+{
+public:
+	virtual const char *GetInterfaceName()
+	{
+		return SMINTERFACE_OUTPUTINFO_NAME;
+	}
+
+	virtual unsigned int GetInterfaceVersion()
+	{
+		return SMINTERFACE_OUTPUTINFO_VERSION;
+	}
+
+public:
+	/**
+	 * @brief Resolves a named output field of an entity.
+	 *
+	 * @param pEntity		Entity to use.
+	 * @param pszOutput		Datamap name of the output (e.g. m_OnTrigger).
+	 * @return				Output, or NULL if the entity has no such output.
+	 */
+	virtual CBaseEntityOutput *FindOutput(CBaseEntity *pEntity, const char *pszOutput) =0;
+
+	/**
+	 * @brief Returns the number of actions of an output.
+	 */
+	virtual int GetActionCount(CBaseEntityOutput *pOutput) =0;
+
+	/**
+	 * @brief Returns the first action of an output, or NULL if it has none.
+	 */
+	virtual CEventAction *GetFirstAction(CBaseEntityOutput *pOutput) =0;
+
+	/**
+	 * @brief Returns the action after pAction, or NULL at the end of the list.
+	 */
+	virtual CEventAction *GetNextAction(CEventAction *pAction) =0;
+
+	/**
+	 * @brief Returns the action at an index, or NULL if the index is out of range.
+	 */
+	virtual CEventAction *GetAction(CBaseEntityOutput *pOutput, int index) =0;
+
+	/**
+	 * @brief Reads every field of an action.
+	 */
+	virtual void GetActionData(CEventAction *pAction, OutputActionData *pData) =0;
+
+	/**
+	 * @brief Returns the unique stamp of an action. A pointer to a freed action
+	 * may be reused by a new one, the stamp will differ.
+	 */
+	virtual int GetActionStamp(CEventAction *pAction) =0;
+
+	/**
+	 * @brief Returns a counter that changes whenever an action is inserted into
+	 * or removed from the output through this extension.
+	 */
+	virtual unsigned int GetListVersion(CBaseEntityOutput *pOutput) =0;
+
+	/**
+	 * @brief Sets the target of an action. The entity and output owning the
+	 * action are needed to keep the reverse target index up to date.
+	 */
+	virtual void SetActionTarget(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction, const char *pszTarget) =0;
+
+	/**
+	 * @brief Sets the input an action fires.
+	 */
+	virtual void SetActionTargetInput(CEventAction *pAction, const char *pszTargetInput) =0;
+
+	/**
+	 * @brief Sets the parameter an action sends.
+	 */
+	virtual void SetActionParameter(CEventAction *pAction, const char *pszParameter) =0;
+
+	/**
+	 * @brief Sets the delay of an action.
+	 */
+	virtual void SetActionDelay(CEventAction *pAction, float flDelay) =0;
+
+	/**
+	 * @brief Sets how many times an action fires. Use RemoveAction, not 0, to
+	 * delete an action.
+	 */
+	virtual void SetActionTimesToFire(CEventAction *pAction, int nTimesToFire) =0;
+
+	/**
+	 * @brief Returns whether actions can be inserted and removed on this engine.
+	 * Always true; the extension brings its own allocator where the game's pool
+	 * can't be resolved.
+	 */
+	virtual bool CanAllocateActions() =0;
+
+	/**
+	 * @brief Allocates an action the game can free and inserts it.
+	 *
+	 * @param pEntity		Entity owning the output.
+	 * @param pOutput		Output to insert into.
+	 * @param data			Fields of the new action; NULL strings are empty.
+	 * @param index			Index the action is inserted at, 0 for the front.
+	 *						The action count appends; the list may be empty.
+	 * @return				New action, or NULL if the index is out of range.
+	 */
+	virtual CEventAction *InsertAction(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, const OutputActionData &data, int index = 0) =0;
+
+	/**
+	 * @brief Unlinks an action from an output and frees it.
+	 *
+	 * @return				False if the action is not in the output's list.
+	 */
+	virtual bool RemoveAction(CBaseEntityOutput *pOutput, CEventAction *pAction) =0;
+
+	/**
+	 * @brief Removes every action of an output.
+	 *
+	 * @return				Number of actions removed.
+	 */
+	virtual int ClearOutput(CBaseEntityOutput *pOutput) =0;
+};
+
+#endif // _INCLUDE_OUTPUTINFO_IOUTPUTINFO_H_
@@ -0,0 +1,255 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "actioniterator.h"
+#include "actionrefs.h"
+#include "entityoutput.h"
+#include "outputkey.h"
+
+/**
+ * @file actioniterator.cpp
+ * @brief Cursor over an output's action list.
+ */
+
+OutputActionIteratorManager g_ActionIterators;
+
+bool OutputActionIteratorManager::Init(char *error, size_t maxlength)
+{
+	HandleError err;
+	m_Type = handlesys->CreateType("OutputActionIterator", this, 0, NULL, NULL, myself->GetIdentity(), &err);
+	if (m_Type == 0)
+	{
+		snprintf(error, maxlength, "Failed to create OutputActionIterator handle type (error %d)", err);
+		return false;
+	}
+
+	return true;
+}
+
+void OutputActionIteratorManager::Shutdown()
+{
+	handlesys->RemoveType(m_Type, myself->GetIdentity());
+}
+
+OutputActionIterator *OutputActionIteratorManager::ReadIterator(IPluginContext *pContext, cell_t hndl)
+{
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	OutputActionIterator *pIter;
+	HandleError err = handlesys->ReadHandle(static_cast<Handle_t>(hndl), m_Type, &sec, (void **)&pIter);
+	if (err != HandleError_None)
+	{
+		pContext->ThrowNativeError("Invalid OutputActionIterator handle %x (error %d)", hndl, err);
+		return nullptr;
+	}
+
+	if (gamehelpers->ReferenceToEntity(pIter->entref) != pIter->pEntity)
+	{
+		pContext->ThrowNativeError("Entity %d of OutputActionIterator is no longer valid", gamehelpers->ReferenceToIndex(pIter->entref));
+		return nullptr;
+	}
+
+	if (GetOutputListVersion(pIter->pOutput) != pIter->version)
+	{
+		pContext->ThrowNativeError("Output action list was modified during iteration");
+		return nullptr;
+	}
+
+	// The game frees actions whose fire count runs out without telling us.
+	if (pIter->pCurrent && (pIter->pCurrent->m_iIDStamp != pIter->stamp || pIter->pCurrent->m_nTimesToFire == 0))
+	{
+		pContext->ThrowNativeError("Output action list was modified during iteration");
+		return nullptr;
+	}
+
+	return pIter;
+}
+
+CEventAction *OutputActionIteratorManager::ReadCurrent(IPluginContext *pContext, cell_t hndl, OutputActionIterator **ppIter)
+{
+	OutputActionIterator *pIter = ReadIterator(pContext, hndl);
+	if (!pIter)
+		return nullptr;
+
+	if (!pIter->pCurrent)
+	{
+		pContext->ThrowNativeError("OutputActionIterator is not on an action, call Next() first");
+		return nullptr;
+	}
+
+	if (ppIter)
+		*ppIter = pIter;
+
+	return pIter->pCurrent;
+}
+
+void OutputActionIteratorManager::OnHandleDestroy(HandleType_t type, void *object)
+{
+	delete (OutputActionIterator *)object;
+}
+
+template <OutputParamReader Read>
+cell_t OutputActionIterator_OutputActionIterator(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+
+	if (pEntityOutput == NULL)
+		return BAD_HANDLE;
+
+	OutputActionIterator *pIter = new OutputActionIterator;
+	pIter->entref = gamehelpers->EntityToReference(pEntity);
+	pIter->pEntity = pEntity;
+	pIter->pOutput = pEntityOutput;
+	pIter->pCurrent = nullptr;
+	pIter->stamp = 0;
+	pIter->index = -1;
+	pIter->version = GetOutputListVersion(pEntityOutput);
+	pIter->started = false;
+
+	HandleError err;
+	Handle_t hndl = handlesys->CreateHandle(g_ActionIterators.m_Type, pIter, pContext->GetIdentity(), myself->GetIdentity(), &err);
+	if (hndl == BAD_HANDLE)
+	{
+		delete pIter;
+		return pContext->ThrowNativeError("Unable to create OutputActionIterator handle (error %d)", err);
+	}
+
+	return hndl;
+}
+
+cell_t OutputActionIterator_Next(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionIterator *pIter = g_ActionIterators.ReadIterator(pContext, params[1]);
+	if (!pIter)
+		return 0;
+
+	if (!pIter->started)
+	{
+		pIter->started = true;
+		pIter->pCurrent = pIter->pOutput->m_ActionList;
+	}
+	else if (pIter->pCurrent)
+	{
+		pIter->pCurrent = pIter->pCurrent->m_pNext;
+	}
+
+	if (!pIter->pCurrent)
+		return 0;
+
+	pIter->stamp = pIter->pCurrent->m_iIDStamp;
+	pIter->index++;
+	return 1;
+}
+
+cell_t OutputActionIterator_Index_get(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionIterator *pIter;
+	if (!g_ActionIterators.ReadCurrent(pContext, params[1], &pIter))
+		return -1;
+
+	return pIter->index;
+}
+
+cell_t OutputActionIterator_Action_get(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionIterator *pIter;
+	CEventAction *pAction = g_ActionIterators.ReadCurrent(pContext, params[1], &pIter);
+	if (!pAction)
+		return 0;
+
+	return g_ActionRefs.Register(pIter->pEntity, pIter->pOutput, pAction);
+}
+
+cell_t OutputActionIterator_GetTarget(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = g_ActionIterators.ReadCurrent(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[2], params[3], pAction->m_iTarget.ToCStr());
+	return 1;
+}
+
+cell_t OutputActionIterator_GetTargetInput(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = g_ActionIterators.ReadCurrent(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[2], params[3], pAction->m_iTargetInput.ToCStr());
+	return 1;
+}
+
+cell_t OutputActionIterator_GetParameter(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = g_ActionIterators.ReadCurrent(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[2], params[3], pAction->m_iParameter.ToCStr());
+	return 1;
+}
+
+cell_t OutputActionIterator_Delay_get(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = g_ActionIterators.ReadCurrent(pContext, params[1]);
+	if (!pAction)
+		return sp_ftoc(-1.0f);
+
+	return sp_ftoc(pAction->m_flDelay);
+}
+
+cell_t OutputActionIterator_TimesToFire_get(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = g_ActionIterators.ReadCurrent(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	return pAction->m_nTimesToFire;
+}
+
+const sp_nativeinfo_t g_ActionIteratorNatives[] =
+{
+	{ "OutputActionIterator.OutputActionIterator",	OutputActionIterator_OutputActionIterator<ReadOutputByName> },
+	{ "OutputKey.Iterate",							OutputActionIterator_OutputActionIterator<ReadOutputByKey> },
+	{ "OutputActionIterator.Next",					OutputActionIterator_Next },
+	{ "OutputActionIterator.Index.get",				OutputActionIterator_Index_get },
+	{ "OutputActionIterator.Action.get",			OutputActionIterator_Action_get },
+	{ "OutputActionIterator.GetTarget",				OutputActionIterator_GetTarget },
+	{ "OutputActionIterator.GetTargetInput",		OutputActionIterator_GetTargetInput },
+	{ "OutputActionIterator.GetParameter",			OutputActionIterator_GetParameter },
+	{ "OutputActionIterator.Delay.get",				OutputActionIterator_Delay_get },
+	{ "OutputActionIterator.TimesToFire.get",		OutputActionIterator_TimesToFire_get },
+	{ NULL, NULL },
+};
@@ -0,0 +1,89 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_ACTIONITERATOR_H_
+#define _INCLUDE_OUTPUTINFO_ACTIONITERATOR_H_
+
+/**
+ * @file actioniterator.h
+ * @brief Cursor over an output's action list.
+ */
+
+#include "extension.h"
+
+class CEventAction;
+class CBaseEntityOutput;
+
+/**
+ * Holds the output and the current action so each step is O(1) instead of
+ * walking from the head of m_ActionList. Every step re-validates the entity
+ * and the list version, so a removed entity or a modified list is reported
+ * instead of followed.
+ */
+struct OutputActionIterator
+{
+	cell_t entref;
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pOutput;
+	CEventAction *pCurrent;
+	int stamp;
+	int index;
+	unsigned int version;
+	bool started;
+};
+
+class OutputActionIteratorManager : public IHandleTypeDispatch
+{
+public:
+	bool Init(char *error, size_t maxlength);
+	void Shutdown();
+
+	/**
+	 * @brief Reads and validates an iterator handle, throwing on failure.
+	 */
+	OutputActionIterator *ReadIterator(IPluginContext *pContext, cell_t hndl);
+
+	/**
+	 * @brief Like ReadIterator, but also requires the cursor to be on an action.
+	 */
+	CEventAction *ReadCurrent(IPluginContext *pContext, cell_t hndl, OutputActionIterator **ppIter = nullptr);
+
+public: // IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object);
+
+public:
+	HandleType_t m_Type;
+};
+
+extern OutputActionIteratorManager g_ActionIterators;
+extern const sp_nativeinfo_t g_ActionIteratorNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_ACTIONITERATOR_H_
@@ -0,0 +1,288 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "actionpool.h"
+#include <algorithm>
+
+/**
+ * @file actionpool.cpp
+ * @brief Allocation, statistics and pre-growing of CEventAction blocks.
+ */
+
+// Same growth step as the game's own CEventAction allocator
+#define ACTION_SLAB_BLOCKS		128
+
+OutputActionAllocator g_ActionAllocator;
+
+void *AllocEventAction()
+{
+	return g_ActionAllocator.Alloc();
+}
+
+void FreeEventAction(void *pMem)
+{
+	g_ActionAllocator.Free(pMem);
+}
+
+/**
+ * Exposes the pool's protected bookkeeping; never instantiated.
+ */
+class CActionPoolAccessor : public CUtlMemoryPool
+{
+public:
+	int BlockSize() { return m_BlockSize; }
+	int NumBlobs() { return m_NumBlobs; }
+
+	int NumFree()
+	{
+		// Free blocks are chained through their first pointer
+		int count = 0;
+		for (void *pBlock = m_pHeadOfFreeList; pBlock != NULL; pBlock = *(void **)pBlock)
+			count++;
+
+		return count;
+	}
+};
+
+OutputActionAllocator::OutputActionAllocator() :
+	m_pPool(nullptr),
+#if SOURCE_ENGINE == SE_CSGO
+	m_pfnAlloc(nullptr),
+#endif
+	m_pFreeList(nullptr), m_Allocated(0), m_Peak(0), m_Free(0)
+{
+}
+
+bool OutputActionAllocator::Init(IGameConfig *pGameConf, char *error, size_t maxlength)
+{
+#if SOURCE_ENGINE == SE_CSGO
+	// CS:GO's actions share g_EntityListPool with other entity lists, which
+	// our block size can't match, so the pool is required there
+#ifdef PLATFORM_WINDOWS
+	pGameConf->GetAddress("g_EntityListPool", reinterpret_cast<void**>(&m_pPool));
+	if(m_pPool == nullptr)
+	{
+		snprintf(error, maxlength, "Failed to obtain g_pEntityListPool from gamedata");
+		return false;
+	}
+#else
+	char *operator_new_reloffset = nullptr;
+	pGameConf->GetMemSig("rel_CEventAction_operator_new", reinterpret_cast<void**>(&operator_new_reloffset));
+	if (operator_new_reloffset == nullptr) {
+		snprintf( error, maxlength, "Failed to obtain rel_CEventAction_operator_new from gamedata" );
+		return false;
+	}
+	operator_new_reloffset += 1;
+	m_pPool = *(CUtlMemoryPool**)((intptr_t)(operator_new_reloffset + 4) + *(intptr_t*)operator_new_reloffset + 12);
+#endif
+
+#ifdef PLATFORM_WINDOWS
+	pGameConf->GetMemSig("g_EntityListPool.Alloc", reinterpret_cast<void**>(&m_pfnAlloc));
+	if(m_pfnAlloc == nullptr)
+	{
+		snprintf( error, maxlength, "Failed to obtain g_EntityListPool.Alloc from gamedata" );
+		return false;
+	}
+#else
+	pGameConf->GetMemSig( "CUtlMemoryPool_Alloc", reinterpret_cast<void**>( &m_pfnAlloc ) );
+	if( m_pfnAlloc == nullptr )
+	{
+		snprintf( error, maxlength, "Failed to obtain CUtlMemoryPool_Alloc from gamedata" );
+		return false;
+	}
+#endif
+#else
+	// Optional; our free list stands in where the symbol isn't exported
+	pGameConf->GetAddress("CEventAction::s_Allocator", reinterpret_cast<void**>(&m_pPool));
+#endif
+
+	return true;
+}
+
+void *OutputActionAllocator::AllocFromGame()
+{
+#if SOURCE_ENGINE == SE_CSGO
+#ifdef PLATFORM_WINDOWS
+	return m_pfnAlloc();
+#else
+	return m_pfnAlloc(m_pPool);
+#endif
+#else
+	return m_pPool->Alloc();
+#endif
+}
+
+bool OutputActionAllocator::AddSlab()
+{
+	size_t blockSize = std::max(sizeof(CEventAction), sizeof(void *));
+
+	char *pSlab = (char *)malloc(blockSize * ACTION_SLAB_BLOCKS);
+	if (!pSlab)
+		return false;
+
+	m_Slabs.push_back(pSlab);
+
+	for (int i = ACTION_SLAB_BLOCKS - 1; i >= 0; i--)
+	{
+		void *pBlock = pSlab + i * blockSize;
+		*(void **)pBlock = m_pFreeList;
+		m_pFreeList = pBlock;
+	}
+
+	m_Free += ACTION_SLAB_BLOCKS;
+	return true;
+}
+
+void *OutputActionAllocator::Alloc()
+{
+	if (m_pPool)
+		return AllocFromGame();
+
+	if (!m_pFreeList && !AddSlab())
+		return nullptr;
+
+	void *pBlock = m_pFreeList;
+	m_pFreeList = *(void **)pBlock;
+	m_Free--;
+
+	if (++m_Allocated > m_Peak)
+		m_Peak = m_Allocated;
+
+	return pBlock;
+}
+
+void OutputActionAllocator::Free(void *pMem)
+{
+	if (m_pPool)
+	{
+		m_pPool->Free(pMem);
+		return;
+	}
+
+	// May be a block the game allocated; it joins our free list all the same
+	*(void **)pMem = m_pFreeList;
+	m_pFreeList = pMem;
+	m_Free++;
+
+	if (m_Allocated > 0)
+		m_Allocated--;
+}
+
+void OutputActionAllocator::GetStats(ActionPoolStats &stats)
+{
+	if (m_pPool)
+	{
+		CActionPoolAccessor *pPool = static_cast<CActionPoolAccessor *>(m_pPool);
+		stats.blockSize = pPool->BlockSize();
+		stats.count = pPool->Count();
+		stats.peak = pPool->PeakCount();
+		stats.free = pPool->NumFree();
+		stats.blobs = pPool->NumBlobs();
+		return;
+	}
+
+	// The game pool's counters drift once blocks cross between the two lists
+	stats.blockSize = (int)std::max(sizeof(CEventAction), sizeof(void *));
+	stats.count = m_Allocated;
+	stats.peak = m_Peak;
+	stats.free = m_Free;
+	stats.blobs = (int)m_Slabs.size();
+}
+
+int OutputActionAllocator::Reserve(int count)
+{
+	if (!m_pPool)
+	{
+		while (m_Free < count && AddSlab())
+			;
+
+		return m_Free;
+	}
+
+	CActionPoolAccessor *pPool = static_cast<CActionPoolAccessor *>(m_pPool);
+
+	int free = pPool->NumFree();
+	if (free >= count)
+		return free;
+
+	// Taking the blocks makes the pool add blobs now; giving them back keeps them on the free list
+	std::vector<void *> blocks;
+	blocks.reserve(count - free);
+
+	for (int i = free; i < count; i++)
+	{
+		void *pBlock = AllocFromGame();
+		if (!pBlock)
+			break;
+
+		blocks.push_back(pBlock);
+	}
+
+	for (size_t i = 0; i < blocks.size(); i++)
+		pPool->Free(blocks[i]);
+
+	return pPool->NumFree();
+}
+
+cell_t GetOutputActionPoolStats(IPluginContext *pContext, const cell_t *params)
+{
+	ActionPoolStats stats;
+	g_ActionAllocator.GetStats(stats);
+
+	cell_t *pCount, *pPeak, *pFree, *pBlobs;
+	pContext->LocalToPhysAddr(params[1], &pCount);
+	pContext->LocalToPhysAddr(params[2], &pPeak);
+	pContext->LocalToPhysAddr(params[3], &pFree);
+	pContext->LocalToPhysAddr(params[4], &pBlobs);
+
+	*pCount = stats.count;
+	*pPeak = stats.peak;
+	*pFree = stats.free;
+	*pBlobs = stats.blobs;
+	return 1;
+}
+
+cell_t ReserveOutputActions(IPluginContext *pContext, const cell_t *params)
+{
+	if (params[1] < 0)
+	{
+		return pContext->ThrowNativeError("Invalid count %d", params[1]);
+	}
+
+	return g_ActionAllocator.Reserve(params[1]);
+}
+
+const sp_nativeinfo_t g_ActionPoolNatives[] =
+{
+	{ "GetOutputActionPoolStats",	GetOutputActionPoolStats },
+	{ "ReserveOutputActions",		ReserveOutputActions },
+	{ NULL, NULL },
+};
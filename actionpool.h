@@ -0,0 +1,132 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_ACTIONPOOL_H_
+#define _INCLUDE_OUTPUTINFO_ACTIONPOOL_H_
+
+/**
+ * @file actionpool.h
+ * @brief Allocation, statistics and pre-growing of CEventAction blocks.
+ */
+
+#include "extension.h"
+#include "entityoutput.h"
+#include <vector>
+
+#if SOURCE_ENGINE == SE_CSGO
+#ifdef PLATFORM_WINDOWS
+typedef int* (*AllocFunction)();
+#else
+typedef int* (*AllocFunction)(void*);
+#endif
+#endif
+
+/**
+ * @brief Snapshot of the action allocator's bookkeeping.
+ */
+struct ActionPoolStats
+{
+	int blockSize;
+	int count;		/**< Blocks in use */
+	int peak;		/**< Most blocks ever in use */
+	int free;		/**< Blocks on the free list */
+	int blobs;		/**< Blobs the pool has grown to */
+};
+
+/**
+ * Hands out CEventAction blocks the game can free, and frees blocks the game
+ * allocated. Where gamedata resolves the game's pool (g_EntityListPool on
+ * CS:GO, the class's fixed-size CEventAction::s_Allocator elsewhere) blocks
+ * come from that pool.
+ *
+ * Otherwise blocks come from our own fixed-block free list. The game's
+ * operator delete still returns actions it expires to its own pool, which
+ * adopts our blocks as its free blocks, and ours adopts the game's blocks we
+ * remove. Our slabs can therefore outlive us inside the game's pool and are
+ * never released, not even on unload.
+ *
+ * The same exchange skews the game pool's own counters, so in that mode
+ * GetStats reports ours instead. They only see blocks passing through us:
+ * count misses our blocks the game frees, and free includes game blocks we
+ * adopted.
+ */
+class OutputActionAllocator
+{
+public:
+	OutputActionAllocator();
+
+	/**
+	 * @brief Resolves the game's pool from gamedata.
+	 *
+	 * @return				False if this engine can't work without the pool
+	 *						and it was not found.
+	 */
+	bool Init(IGameConfig *pGameConf, char *error, size_t maxlength);
+
+	void *Alloc();
+	void Free(void *pMem);
+
+	/**
+	 * @brief Returns whether blocks come from the game's pool rather than ours.
+	 */
+	bool UsesGamePool() { return m_pPool != nullptr; }
+
+	void GetStats(ActionPoolStats &stats);
+
+	/**
+	 * @brief Grows the pool until at least count blocks are free, so a later
+	 * bulk insert doesn't allocate mid-tick.
+	 *
+	 * @return				Number of free blocks afterwards.
+	 */
+	int Reserve(int count);
+
+private:
+	void *AllocFromGame();
+	bool AddSlab();
+
+private:
+	CUtlMemoryPool *m_pPool;
+#if SOURCE_ENGINE == SE_CSGO
+	AllocFunction m_pfnAlloc;
+#endif
+
+	void *m_pFreeList;		/**< Free blocks, chained through their first pointer */
+	std::vector<void *> m_Slabs;
+	int m_Allocated;
+	int m_Peak;
+	int m_Free;
+};
+
+extern OutputActionAllocator g_ActionAllocator;
+extern const sp_nativeinfo_t g_ActionPoolNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_ACTIONPOOL_H_
@@ -0,0 +1,364 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "actionrefs.h"
+#include "entityoutput.h"
+#include "outputkey.h"
+#include "stringpool.h"
+
+/**
+ * @file actionrefs.cpp
+ * @brief Stable references to output actions, keyed by CEventAction::m_iIDStamp.
+ */
+
+OutputActionRefs g_ActionRefs;
+
+void OnEventActionFreed(CEventAction *pAction)
+{
+	g_ActionRefs.OnActionFreed(pAction);
+}
+
+int OutputActionRefs::Register(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction)
+{
+	ActionRef &ref = m_Refs[pAction->m_iIDStamp];
+	ref.pAction = pAction;
+	ref.pOutput = pOutput;
+	ref.entref = gamehelpers->EntityToReference(pEntity);
+
+	return pAction->m_iIDStamp;
+}
+
+CEventAction *OutputActionRefs::Resolve(int ref, CBaseEntity **ppEntity, CBaseEntityOutput **ppOutput)
+{
+	auto it = m_Refs.find(ref);
+	if (it == m_Refs.end())
+		return nullptr;
+
+	const ActionRef &entry = it->second;
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(entry.entref);
+	if (!pEntity || entry.pAction->m_iIDStamp != ref || entry.pAction->m_nTimesToFire == 0)
+	{
+		m_Refs.erase(it);
+		return nullptr;
+	}
+
+	if (ppEntity)
+		*ppEntity = pEntity;
+	if (ppOutput)
+		*ppOutput = entry.pOutput;
+
+	return entry.pAction;
+}
+
+void OutputActionRefs::OnActionFreed(CEventAction *pAction)
+{
+	auto it = m_Refs.find(pAction->m_iIDStamp);
+	if (it != m_Refs.end() && it->second.pAction == pAction)
+		m_Refs.erase(it);
+}
+
+void OutputActionRefs::Clear()
+{
+	m_Refs.clear();
+}
+
+static CEventAction *ReadActionRef(IPluginContext *pContext, cell_t ref, CBaseEntity **ppEntity = nullptr, CBaseEntityOutput **ppOutput = nullptr)
+{
+	CEventAction *pAction = g_ActionRefs.Resolve(ref, ppEntity, ppOutput);
+	if (!pAction)
+	{
+		pContext->ThrowNativeError("Invalid or stale OutputAction reference %d", ref);
+		return nullptr;
+	}
+
+	return pAction;
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputActionRef(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+
+	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+		return 0;
+
+	CEventAction *pAction = pEntityOutput->m_ActionList;
+	for(int i = 0; i < params[3]; i++)
+	{
+		if( pAction->m_pNext == NULL)
+			return 0;
+
+		pAction = pAction->m_pNext;
+	}
+
+	return g_ActionRefs.Register(pEntity, pEntityOutput, pAction);
+}
+
+cell_t OutputAction_Valid_get(IPluginContext *pContext, const cell_t *params)
+{
+	return g_ActionRefs.Resolve(params[1]) != nullptr;
+}
+
+cell_t OutputAction_Entity_get(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	if (!ReadActionRef(pContext, params[1], &pEntity))
+		return -1;
+
+	return gamehelpers->EntityToBCompatRef(pEntity);
+}
+
+cell_t OutputAction_Index_get(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntityOutput *pEntityOutput;
+	CEventAction *pAction = ReadActionRef(pContext, params[1], nullptr, &pEntityOutput);
+	if (!pAction)
+		return -1;
+
+	int index = 0;
+	for (CEventAction *ev = pEntityOutput->m_ActionList; ev != NULL; ev = ev->m_pNext, index++)
+	{
+		if (ev == pAction)
+			return index;
+	}
+
+	return -1;
+}
+
+cell_t OutputAction_GetOutputName(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!ReadActionRef(pContext, params[1], &pEntity, &pEntityOutput))
+		return 0;
+
+	const char *pszName = GetOutputName(pEntity, pEntityOutput);
+	if (!pszName)
+		return 0;
+
+	pContext->StringToLocal(params[2], params[3], pszName);
+	return 1;
+}
+
+cell_t OutputAction_GetTarget(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[2], params[3], pAction->m_iTarget.ToCStr());
+	return 1;
+}
+
+cell_t OutputAction_SetTarget(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	CEventAction *pAction = ReadActionRef(pContext, params[1], &pEntity, &pEntityOutput);
+	if (!pAction)
+		return 0;
+
+	char *szTarget;
+	pContext->LocalToString(params[2], &szTarget);
+	pAction->m_iTarget = AllocPooledString(szTarget);
+	OnOutputActionChanged(pEntity, pEntityOutput, pAction);
+	return 1;
+}
+
+cell_t OutputAction_GetTargetInput(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[2], params[3], pAction->m_iTargetInput.ToCStr());
+	return 1;
+}
+
+cell_t OutputAction_SetTargetInput(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	char *szTargetInput;
+	pContext->LocalToString(params[2], &szTargetInput);
+	pAction->m_iTargetInput = AllocPooledString(szTargetInput);
+	return 1;
+}
+
+cell_t OutputAction_GetParameter(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[2], params[3], pAction->m_iParameter.ToCStr());
+	return 1;
+}
+
+cell_t OutputAction_SetParameter(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	char *szParameter;
+	pContext->LocalToString(params[2], &szParameter);
+	pAction->m_iParameter = AllocPooledString(szParameter);
+	return 1;
+}
+
+cell_t OutputAction_TargetId_get(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	return PooledStringId(pAction->m_iTarget);
+}
+
+cell_t OutputAction_TargetInputId_get(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	return PooledStringId(pAction->m_iTargetInput);
+}
+
+cell_t OutputAction_ParameterId_get(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	return PooledStringId(pAction->m_iParameter);
+}
+
+cell_t OutputAction_Delay_get(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return sp_ftoc(-1.0f);
+
+	return sp_ftoc(pAction->m_flDelay);
+}
+
+cell_t OutputAction_Delay_set(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	pAction->m_flDelay = sp_ctof(params[2]);
+	return 1;
+}
+
+cell_t OutputAction_TimesToFire_get(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = ReadActionRef(pContext, params[1]);
+	if (!pAction)
+		return 0;
+
+	return pAction->m_nTimesToFire;
+}
+
+static bool RemoveAction(CBaseEntityOutput *pEntityOutput, CEventAction *pAction)
+{
+	for (CEventAction **ppLink = &pEntityOutput->m_ActionList; *ppLink != NULL; ppLink = &(*ppLink)->m_pNext)
+	{
+		if (*ppLink == pAction)
+		{
+			*ppLink = pAction->m_pNext;
+			delete pAction;
+			OnOutputListChanged(pEntityOutput);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+cell_t OutputAction_TimesToFire_set(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntityOutput *pEntityOutput;
+	CEventAction *pAction = ReadActionRef(pContext, params[1], nullptr, &pEntityOutput);
+	if (!pAction)
+		return 0;
+
+	if (params[2] == 0) // delete this action
+	{
+		return RemoveAction(pEntityOutput, pAction);
+	}
+
+	pAction->m_nTimesToFire = params[2];
+	return 1;
+}
+
+cell_t OutputAction_Remove(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntityOutput *pEntityOutput;
+	CEventAction *pAction = ReadActionRef(pContext, params[1], nullptr, &pEntityOutput);
+	if (!pAction)
+		return 0;
+
+	return RemoveAction(pEntityOutput, pAction);
+}
+
+const sp_nativeinfo_t g_ActionRefNatives[] =
+{
+	{ "GetOutputActionRef",				GetOutputActionRef<ReadOutputByName> },
+	{ "OutputKey.GetActionRef",			GetOutputActionRef<ReadOutputByKey> },
+	{ "OutputAction.Valid.get",			OutputAction_Valid_get },
+	{ "OutputAction.Entity.get",		OutputAction_Entity_get },
+	{ "OutputAction.Index.get",			OutputAction_Index_get },
+	{ "OutputAction.GetOutputName",		OutputAction_GetOutputName },
+	{ "OutputAction.GetTarget",			OutputAction_GetTarget },
+	{ "OutputAction.SetTarget",			OutputAction_SetTarget },
+	{ "OutputAction.GetTargetInput",	OutputAction_GetTargetInput },
+	{ "OutputAction.SetTargetInput",	OutputAction_SetTargetInput },
+	{ "OutputAction.GetParameter",		OutputAction_GetParameter },
+	{ "OutputAction.SetParameter",		OutputAction_SetParameter },
+	{ "OutputAction.TargetId.get",		OutputAction_TargetId_get },
+	{ "OutputAction.TargetInputId.get",	OutputAction_TargetInputId_get },
+	{ "OutputAction.ParameterId.get",	OutputAction_ParameterId_get },
+	{ "OutputAction.Delay.get",			OutputAction_Delay_get },
+	{ "OutputAction.Delay.set",			OutputAction_Delay_set },
+	{ "OutputAction.TimesToFire.get",	OutputAction_TimesToFire_get },
+	{ "OutputAction.TimesToFire.set",	OutputAction_TimesToFire_set },
+	{ "OutputAction.Remove",			OutputAction_Remove },
+	{ NULL, NULL },
+};
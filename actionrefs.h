@@ -0,0 +1,92 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_ACTIONREFS_H_
+#define _INCLUDE_OUTPUTINFO_ACTIONREFS_H_
+
+/**
+ * @file actionrefs.h
+ * @brief Stable references to output actions, keyed by CEventAction::m_iIDStamp.
+ */
+
+#include "extension.h"
+#include <unordered_map>
+
+class CEventAction;
+class CBaseEntityOutput;
+
+/**
+ * Index from an action's ID stamp to where it lives, so plugins can keep
+ * addressing an action while others insert or remove around it.
+ *
+ * Entries are dropped when we free the action ourselves. Actions the game
+ * frees (an entity being removed, or TimesToFire running out) are caught
+ * lazily on lookup: the entity reference no longer resolves, or the action's
+ * stamp or fire count no longer match.
+ */
+class OutputActionRefs
+{
+public:
+	/**
+	 * @brief Adds an action to the index.
+	 *
+	 * @return				The action's ID stamp, used as its reference.
+	 */
+	int Register(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction);
+
+	/**
+	 * @brief Looks up a live action by reference.
+	 *
+	 * @param ref			Reference returned by Register.
+	 * @param ppEntity		Optional, receives the owning entity.
+	 * @param ppOutput		Optional, receives the owning output.
+	 * @return				Action, or nullptr if it no longer exists.
+	 */
+	CEventAction *Resolve(int ref, CBaseEntity **ppEntity = nullptr, CBaseEntityOutput **ppOutput = nullptr);
+
+	void OnActionFreed(CEventAction *pAction);
+	void Clear();
+
+private:
+	struct ActionRef
+	{
+		CEventAction *pAction;
+		CBaseEntityOutput *pOutput;
+		cell_t entref;
+	};
+
+	std::unordered_map<int, ActionRef> m_Refs;
+};
+
+extern OutputActionRefs g_ActionRefs;
+extern const sp_nativeinfo_t g_ActionRefNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_ACTIONREFS_H_
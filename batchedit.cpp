@@ -0,0 +1,370 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "batchedit.h"
+#include "entityoutput.h"
+#include "outputkey.h"
+#include "stringpool.h"
+
+/**
+ * @file batchedit.cpp
+ * @brief Transactional edits of a single output's action list.
+ */
+
+OutputEditBatchManager g_BatchEdits;
+
+bool OutputEditBatch::Apply(CBaseEntity *pEntity, CBaseEntityOutput *pEntityOutput)
+{
+	m_FailedOp = -1;
+
+	std::vector<CEventAction *> actions;
+	for (CEventAction *pAction = pEntityOutput->m_ActionList; pAction != NULL; pAction = pAction->m_pNext)
+		actions.push_back(pAction);
+
+	int count = (int)actions.size();
+
+	// Validate everything up front so a bad op can't leave the list half edited.
+	bool changesList = false;
+	for (size_t i = 0; i < m_Ops.size(); i++)
+	{
+		const OutputEditOp &op = m_Ops[i];
+
+		int maxIndex = op.type == OutputEdit_Insert ? count : count - 1;
+		if (op.index < 0 || op.index > maxIndex)
+		{
+			m_FailedOp = i;
+			return false;
+		}
+
+		if (op.type == OutputEdit_Insert || op.type == OutputEdit_Remove
+			|| (op.type == OutputEdit_SetTimesToFire && op.timestofire == 0))
+		{
+			changesList = true;
+		}
+	}
+
+	std::vector<bool> removed(count, false);
+	std::vector<std::vector<CEventAction *>> inserted(changesList ? count + 1 : 0);
+
+	for (size_t i = 0; i < m_Ops.size(); i++)
+	{
+		const OutputEditOp &op = m_Ops[i];
+
+		switch (op.type)
+		{
+		case OutputEdit_SetTarget:
+			actions[op.index]->m_iTarget = AllocPooledString(op.target.c_str());
+			OnOutputActionChanged(pEntity, pEntityOutput, actions[op.index]);
+			break;
+		case OutputEdit_SetTargetInput:
+			actions[op.index]->m_iTargetInput = AllocPooledString(op.targetinput.c_str());
+			break;
+		case OutputEdit_SetParameter:
+			actions[op.index]->m_iParameter = AllocPooledString(op.parameter.c_str());
+			break;
+		case OutputEdit_SetDelay:
+			actions[op.index]->m_flDelay = op.delay;
+			break;
+		case OutputEdit_SetTimesToFire:
+			if (op.timestofire == 0)
+				removed[op.index] = true;
+			else
+				actions[op.index]->m_nTimesToFire = op.timestofire;
+			break;
+		case OutputEdit_Remove:
+			removed[op.index] = true;
+			break;
+		case OutputEdit_Insert:
+			{
+				CEventAction *pNewAction = new CEventAction;
+				pNewAction->m_iTarget = AllocPooledString(op.target.c_str());
+				pNewAction->m_iTargetInput = AllocPooledString(op.targetinput.c_str());
+				pNewAction->m_iParameter = AllocPooledString(op.parameter.c_str());
+				pNewAction->m_flDelay = op.delay;
+				pNewAction->m_nTimesToFire = op.timestofire;
+				inserted[op.index].push_back(pNewAction);
+				OnOutputActionChanged(pEntity, pEntityOutput, pNewAction);
+			}
+			break;
+		}
+	}
+
+	if (!changesList)
+		return true;
+
+	// Relink the whole list in one pass.
+	CEventAction **ppLink = &pEntityOutput->m_ActionList;
+	for (int i = 0; i <= count; i++)
+	{
+		for (size_t j = 0; j < inserted[i].size(); j++)
+		{
+			*ppLink = inserted[i][j];
+			ppLink = &inserted[i][j]->m_pNext;
+		}
+
+		if (i == count || removed[i])
+			continue;
+
+		*ppLink = actions[i];
+		ppLink = &actions[i]->m_pNext;
+	}
+	*ppLink = NULL;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (removed[i])
+			delete actions[i];
+	}
+
+	OnOutputListChanged(pEntityOutput);
+
+	return true;
+}
+
+bool OutputEditBatchManager::Init(char *error, size_t maxlength)
+{
+	HandleError err;
+	m_Type = handlesys->CreateType("OutputEditBatch", this, 0, NULL, NULL, myself->GetIdentity(), &err);
+	if (m_Type == 0)
+	{
+		snprintf(error, maxlength, "Failed to create OutputEditBatch handle type (error %d)", err);
+		return false;
+	}
+
+	return true;
+}
+
+void OutputEditBatchManager::Shutdown()
+{
+	handlesys->RemoveType(m_Type, myself->GetIdentity());
+}
+
+OutputEditBatch *OutputEditBatchManager::ReadBatch(IPluginContext *pContext, cell_t hndl)
+{
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	OutputEditBatch *pBatch;
+	HandleError err = handlesys->ReadHandle(static_cast<Handle_t>(hndl), m_Type, &sec, (void **)&pBatch);
+	if (err != HandleError_None)
+	{
+		pContext->ThrowNativeError("Invalid OutputEditBatch handle %x (error %d)", hndl, err);
+		return nullptr;
+	}
+
+	return pBatch;
+}
+
+void OutputEditBatchManager::OnHandleDestroy(HandleType_t type, void *object)
+{
+	delete (OutputEditBatch *)object;
+}
+
+static OutputEditOp *AddOp(IPluginContext *pContext, const cell_t *params, OutputEditType type)
+{
+	OutputEditBatch *pBatch = g_BatchEdits.ReadBatch(pContext, params[1]);
+	if (!pBatch)
+		return nullptr;
+
+	pBatch->m_Ops.push_back(OutputEditOp());
+
+	OutputEditOp *pOp = &pBatch->m_Ops.back();
+	pOp->type = type;
+	pOp->index = params[2];
+	pOp->delay = 0.0f;
+	pOp->timestofire = EVENT_FIRE_ALWAYS;
+
+	return pOp;
+}
+
+cell_t OutputEditBatch_OutputEditBatch(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditBatch *pBatch = new OutputEditBatch;
+
+	HandleError err;
+	Handle_t hndl = handlesys->CreateHandle(g_BatchEdits.m_Type, pBatch, pContext->GetIdentity(), myself->GetIdentity(), &err);
+	if (hndl == BAD_HANDLE)
+	{
+		delete pBatch;
+		return pContext->ThrowNativeError("Unable to create OutputEditBatch handle (error %d)", err);
+	}
+
+	return hndl;
+}
+
+cell_t OutputEditBatch_Length_get(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditBatch *pBatch = g_BatchEdits.ReadBatch(pContext, params[1]);
+	if (!pBatch)
+		return 0;
+
+	return pBatch->m_Ops.size();
+}
+
+cell_t OutputEditBatch_FailedOp_get(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditBatch *pBatch = g_BatchEdits.ReadBatch(pContext, params[1]);
+	if (!pBatch)
+		return 0;
+
+	return pBatch->m_FailedOp;
+}
+
+cell_t OutputEditBatch_Clear(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditBatch *pBatch = g_BatchEdits.ReadBatch(pContext, params[1]);
+	if (!pBatch)
+		return 0;
+
+	pBatch->m_Ops.clear();
+	pBatch->m_FailedOp = -1;
+	return 1;
+}
+
+cell_t OutputEditBatch_SetTarget(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditOp *pOp = AddOp(pContext, params, OutputEdit_SetTarget);
+	if (!pOp)
+		return 0;
+
+	char *buffer;
+	pContext->LocalToString(params[3], &buffer);
+	pOp->target = buffer;
+	return 1;
+}
+
+cell_t OutputEditBatch_SetTargetInput(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditOp *pOp = AddOp(pContext, params, OutputEdit_SetTargetInput);
+	if (!pOp)
+		return 0;
+
+	char *buffer;
+	pContext->LocalToString(params[3], &buffer);
+	pOp->targetinput = buffer;
+	return 1;
+}
+
+cell_t OutputEditBatch_SetParameter(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditOp *pOp = AddOp(pContext, params, OutputEdit_SetParameter);
+	if (!pOp)
+		return 0;
+
+	char *buffer;
+	pContext->LocalToString(params[3], &buffer);
+	pOp->parameter = buffer;
+	return 1;
+}
+
+cell_t OutputEditBatch_SetDelay(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditOp *pOp = AddOp(pContext, params, OutputEdit_SetDelay);
+	if (!pOp)
+		return 0;
+
+	pOp->delay = sp_ctof(params[3]);
+	return 1;
+}
+
+cell_t OutputEditBatch_SetTimesToFire(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditOp *pOp = AddOp(pContext, params, OutputEdit_SetTimesToFire);
+	if (!pOp)
+		return 0;
+
+	pOp->timestofire = params[3];
+	return 1;
+}
+
+cell_t OutputEditBatch_Insert(IPluginContext *pContext, const cell_t *params)
+{
+	OutputEditOp *pOp = AddOp(pContext, params, OutputEdit_Insert);
+	if (!pOp)
+		return 0;
+
+	char *buffer;
+	pContext->LocalToString(params[3], &buffer);
+	pOp->target = buffer;
+
+	pContext->LocalToString(params[4], &buffer);
+	pOp->targetinput = buffer;
+
+	pContext->LocalToString(params[5], &buffer);
+	pOp->parameter = buffer;
+
+	pOp->delay = sp_ctof(params[6]);
+	pOp->timestofire = params[7];
+	return 1;
+}
+
+cell_t OutputEditBatch_Remove(IPluginContext *pContext, const cell_t *params)
+{
+	return AddOp(pContext, params, OutputEdit_Remove) != nullptr;
+}
+
+template <OutputParamReader Read>
+cell_t ApplyOutputEdits(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+
+	OutputEditBatch *pBatch = g_BatchEdits.ReadBatch(pContext, params[3]);
+	if (!pBatch)
+		return 0;
+
+	if (pEntityOutput == NULL)
+	{
+		pBatch->m_FailedOp = 0;
+		return 0;
+	}
+
+	return pBatch->Apply(pEntity, pEntityOutput);
+}
+
+const sp_nativeinfo_t g_BatchEditNatives[] =
+{
+	{ "OutputEditBatch.OutputEditBatch",	OutputEditBatch_OutputEditBatch },
+	{ "OutputEditBatch.Length.get",			OutputEditBatch_Length_get },
+	{ "OutputEditBatch.FailedOp.get",		OutputEditBatch_FailedOp_get },
+	{ "OutputEditBatch.Clear",				OutputEditBatch_Clear },
+	{ "OutputEditBatch.SetTarget",			OutputEditBatch_SetTarget },
+	{ "OutputEditBatch.SetTargetInput",		OutputEditBatch_SetTargetInput },
+	{ "OutputEditBatch.SetParameter",		OutputEditBatch_SetParameter },
+	{ "OutputEditBatch.SetDelay",			OutputEditBatch_SetDelay },
+	{ "OutputEditBatch.SetTimesToFire",		OutputEditBatch_SetTimesToFire },
+	{ "OutputEditBatch.Insert",				OutputEditBatch_Insert },
+	{ "OutputEditBatch.Remove",				OutputEditBatch_Remove },
+	{ "ApplyOutputEdits",					ApplyOutputEdits<ReadOutputByName> },
+	{ "OutputKey.ApplyEdits",				ApplyOutputEdits<ReadOutputByKey> },
+	{ NULL, NULL },
+};
@@ -0,0 +1,108 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_BATCHEDIT_H_
+#define _INCLUDE_OUTPUTINFO_BATCHEDIT_H_
+
+/**
+ * @file batchedit.h
+ * @brief Transactional edits of a single output's action list.
+ */
+
+#include "extension.h"
+#include <string>
+#include <vector>
+
+class CBaseEntityOutput;
+
+enum OutputEditType
+{
+	OutputEdit_SetTarget = 0,
+	OutputEdit_SetTargetInput,
+	OutputEdit_SetParameter,
+	OutputEdit_SetDelay,
+	OutputEdit_SetTimesToFire,
+	OutputEdit_Insert,
+	OutputEdit_Remove,
+};
+
+struct OutputEditOp
+{
+	OutputEditType type;
+	int index;
+	std::string target;
+	std::string targetinput;
+	std::string parameter;
+	float delay;
+	int timestofire;
+};
+
+/**
+ * A list of edits against one output. Indices always refer to the action list
+ * as it was before the batch is applied, so removals don't shift later ops.
+ */
+class OutputEditBatch
+{
+public:
+	OutputEditBatch() : m_FailedOp(-1) {}
+
+	/**
+	 * @brief Applies every op in one pass, or none of them.
+	 *
+	 * @return				True on success; on failure m_FailedOp holds the
+	 *						index of the first op that could not be applied.
+	 */
+	bool Apply(CBaseEntity *pEntity, CBaseEntityOutput *pEntityOutput);
+
+public:
+	std::vector<OutputEditOp> m_Ops;
+	int m_FailedOp;
+};
+
+class OutputEditBatchManager : public IHandleTypeDispatch
+{
+public:
+	bool Init(char *error, size_t maxlength);
+	void Shutdown();
+
+	OutputEditBatch *ReadBatch(IPluginContext *pContext, cell_t hndl);
+
+public: // IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object);
+
+public:
+	HandleType_t m_Type;
+};
+
+extern OutputEditBatchManager g_BatchEdits;
+extern const sp_nativeinfo_t g_BatchEditNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_BATCHEDIT_H_
@@ -0,0 +1,202 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "benchmark.h"
+#include "entityoutput.h"
+#include "stringpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdlib.h>
+#include <vector>
+
+/**
+ * @file benchmark.cpp
+ * @brief In-game benchmark of the action list operations behind the natives.
+ *
+ * The scratch output is never attached to an entity, so the engine never fires
+ * or saves it. Its actions come from the game's pool, like the ones Insert creates.
+ */
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+class BenchTimings
+{
+public:
+	BenchTimings(int samples)
+	{
+		m_Nanoseconds.reserve(samples);
+	}
+
+	void Add(BenchClock::duration elapsed)
+	{
+		m_Nanoseconds.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	}
+
+	void Print(const char *pszName)
+	{
+		if (m_Nanoseconds.empty())
+			return;
+
+		std::sort(m_Nanoseconds.begin(), m_Nanoseconds.end());
+
+		double total = 0.0;
+		for (size_t i = 0; i < m_Nanoseconds.size(); i++)
+			total += (double)m_Nanoseconds[i];
+
+		size_t count = m_Nanoseconds.size();
+		rootconsole->ConsolePrint("  %-7s %10.0f ops/s   avg %9.0f ns   p50 %9lld ns   p99 %9lld ns",
+			pszName,
+			total > 0.0 ? count * 1e9 / total : 0.0,
+			total / count,
+			(long long)m_Nanoseconds[count / 2],
+			(long long)m_Nanoseconds[std::min(count - 1, count * 99 / 100)]);
+	}
+
+private:
+	std::vector<long long> m_Nanoseconds;
+};
+
+static CEventAction *ActionAt(CBaseEntityOutput *pOutput, int index)
+{
+	CEventAction *pAction = pOutput->m_ActionList;
+	for (int i = 0; i < index && pAction != NULL; i++)
+		pAction = pAction->m_pNext;
+
+	return pAction;
+}
+
+static void InsertAt(CBaseEntityOutput *pOutput, int index, CEventAction *pAction)
+{
+	CEventAction **ppLink = &pOutput->m_ActionList;
+	for (int i = 0; i < index && *ppLink != NULL; i++)
+		ppLink = &(*ppLink)->m_pNext;
+
+	pAction->m_pNext = *ppLink;
+	*ppLink = pAction;
+}
+
+static CEventAction *RemoveAt(CBaseEntityOutput *pOutput, int index)
+{
+	CEventAction **ppLink = &pOutput->m_ActionList;
+	for (int i = 0; i < index && *ppLink != NULL; i++)
+		ppLink = &(*ppLink)->m_pNext;
+
+	CEventAction *pAction = *ppLink;
+	if (pAction != NULL)
+		*ppLink = pAction->m_pNext;
+
+	return pAction;
+}
+
+static CEventAction *NewBenchAction(string_t target)
+{
+	CEventAction *pAction = new CEventAction(NULL);
+	pAction->m_iTarget = target;
+	pAction->m_iTargetInput = target;
+	pAction->m_iParameter = target;
+	pAction->m_flDelay = 0.0f;
+	pAction->m_nTimesToFire = EVENT_FIRE_ALWAYS;
+	pAction->m_pNext = NULL;
+	return pAction;
+}
+
+void RunOutputBenchmark(int count, int samples)
+{
+	// The destructor is only declared by the game, so don't construct one ourselves
+	CBaseEntityOutput *pOutput = (CBaseEntityOutput *)calloc(1, sizeof(CBaseEntityOutput));
+
+	string_t targets[16];
+	for (int i = 0; i < 16; i++)
+	{
+		char szTarget[32];
+		smutils->Format(szTarget, sizeof(szTarget), "outputinfo_bench_%d", i);
+		targets[i] = AllocPooledString(szTarget);
+	}
+
+	for (int i = 0; i < count; i++)
+		InsertAt(pOutput, 0, NewBenchAction(targets[i % 16]));
+
+	std::mt19937 rng(count);
+	std::uniform_int_distribution<int> pick(0, count - 1);
+
+	BenchTimings get(samples), set(samples), insert(samples), remove(samples);
+
+	for (int i = 0; i < samples; i++)
+	{
+		int index = pick(rng);
+		BenchClock::time_point start = BenchClock::now();
+		CEventAction *pAction = ActionAt(pOutput, index);
+		volatile const char *pszTarget = pAction->m_iTarget.ToCStr();
+		get.Add(BenchClock::now() - start);
+		(void)pszTarget;
+	}
+
+	for (int i = 0; i < samples; i++)
+	{
+		int index = pick(rng);
+		char szTarget[32];
+		smutils->Format(szTarget, sizeof(szTarget), "outputinfo_bench_%d", i % 16);
+
+		BenchClock::time_point start = BenchClock::now();
+		ActionAt(pOutput, index)->m_iTarget = AllocPooledString(szTarget);
+		set.Add(BenchClock::now() - start);
+	}
+
+	// Pair each insert with a remove so the list keeps its length
+	for (int i = 0; i < samples; i++)
+	{
+		int index = pick(rng);
+		BenchClock::time_point start = BenchClock::now();
+		InsertAt(pOutput, index, NewBenchAction(targets[i % 16]));
+		insert.Add(BenchClock::now() - start);
+
+		index = pick(rng);
+		start = BenchClock::now();
+		delete RemoveAt(pOutput, index);
+		remove.Add(BenchClock::now() - start);
+	}
+
+	rootconsole->ConsolePrint("[OutputInfo] %d actions, %d samples:", count, samples);
+	get.Print("get");
+	set.Print("set");
+	insert.Print("insert");
+	remove.Print("remove");
+
+	for (CEventAction *pAction = pOutput->m_ActionList; pAction != NULL; )
+	{
+		CEventAction *pNext = pAction->m_pNext;
+		delete pAction;
+		pAction = pNext;
+	}
+	free(pOutput);
+}
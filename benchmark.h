@@ -0,0 +1,51 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_BENCHMARK_H_
+#define _INCLUDE_OUTPUTINFO_BENCHMARK_H_
+
+/**
+ * @file benchmark.h
+ * @brief In-game benchmark of the action list operations behind the natives.
+ */
+
+#include "extension.h"
+
+/**
+ * @brief Times get/set/insert/remove on a scratch output holding a given
+ * number of actions and prints throughput and latency to the server console.
+ *
+ * @param count			Number of actions in the scratch list.
+ * @param samples		Number of timed operations per benchmark.
+ */
+void RunOutputBenchmark(int count, int samples);
+
+#endif // _INCLUDE_OUTPUTINFO_BENCHMARK_H_
@@ -0,0 +1,310 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "editqueue.h"
+#include "entityoutput.h"
+#include <algorithm>
+
+/**
+ * @file editqueue.cpp
+ * @brief Per-frame queue for action edits of plugins that opted into deferred mode.
+ */
+
+OutputEditQueue g_EditQueue;
+
+static void OnGameFrame(bool simulating)
+{
+	g_EditQueue.Drain();
+}
+
+OutputEditQueue::OutputEditQueue() :
+	m_Count(0),
+	m_Failed(0),
+	m_bRelink(false)
+{
+}
+
+void OutputEditQueue::Init()
+{
+	m_Order.reserve(kCapacity);
+	m_Nodes.reserve(64);
+
+	smutils->AddGameFrameHook(OnGameFrame);
+	plsys->AddPluginsListener(this);
+}
+
+void OutputEditQueue::Shutdown()
+{
+	plsys->RemovePluginsListener(this);
+	smutils->RemoveGameFrameHook(OnGameFrame);
+	Clear();
+}
+
+bool OutputEditQueue::IsDeferred(IPluginContext *pContext)
+{
+	if (m_Deferred.empty())
+		return false;
+
+	return std::find(m_Deferred.begin(), m_Deferred.end(), pContext->GetRuntime()) != m_Deferred.end();
+}
+
+void OutputEditQueue::SetDeferred(IPluginContext *pContext, bool deferred)
+{
+	IPluginRuntime *pRuntime = pContext->GetRuntime();
+	auto it = std::find(m_Deferred.begin(), m_Deferred.end(), pRuntime);
+
+	if (deferred && it == m_Deferred.end())
+		m_Deferred.push_back(pRuntime);
+	else if (!deferred && it != m_Deferred.end())
+		m_Deferred.erase(it);
+}
+
+void OutputEditQueue::OnPluginUnloaded(IPlugin *plugin)
+{
+	auto it = std::find(m_Deferred.begin(), m_Deferred.end(), plugin->GetRuntime());
+	if (it != m_Deferred.end())
+		m_Deferred.erase(it);
+}
+
+OutputEditQueue::Edit *OutputEditQueue::Push(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, OutputEditType type, int index)
+{
+	if (m_Count == kCapacity)
+		Drain();
+
+	Edit &edit = m_Edits[m_Count++];
+	edit.pOutput = pOutput;
+	edit.pEntity = pEntity;
+	edit.entref = gamehelpers->EntityToReference(pEntity);
+	edit.type = type;
+	edit.index = index;
+	edit.target = NULL_STRING;
+	edit.targetInput = NULL_STRING;
+	edit.parameter = NULL_STRING;
+	edit.delay = 0.0f;
+	edit.timesToFire = EVENT_FIRE_ALWAYS;
+
+	return &edit;
+}
+
+int OutputEditQueue::Drain()
+{
+	if (m_Count == 0)
+		return 0;
+
+	m_Order.clear();
+	for (size_t i = 0; i < m_Count; i++)
+		m_Order.push_back(&m_Edits[i]);
+
+	// Stable, so edits to the same output keep the order they were queued in
+	std::stable_sort(m_Order.begin(), m_Order.end(), [](const Edit *a, const Edit *b) {
+		return (uintptr_t)a->pOutput < (uintptr_t)b->pOutput;
+	});
+
+	int applied = 0;
+	size_t first = 0;
+	for (size_t i = 1; i <= m_Order.size(); i++)
+	{
+		if (i == m_Order.size() || m_Order[i]->pOutput != m_Order[first]->pOutput)
+		{
+			applied += ApplyGroup(first, i);
+			first = i;
+		}
+	}
+
+	m_Count = 0;
+	return applied;
+}
+
+void OutputEditQueue::Clear()
+{
+	m_Count = 0;
+}
+
+int OutputEditQueue::ApplyGroup(size_t first, size_t last)
+{
+	CBaseEntityOutput *pOutput = m_Order[first]->pOutput;
+	CBaseEntity *pEntity = nullptr;
+
+	m_Nodes.clear();
+	m_Retargeted.clear();
+	m_Removed.clear();
+	m_bRelink = false;
+
+	int applied = 0;
+	for (size_t i = first; i < last; i++)
+	{
+		const Edit &edit = *m_Order[i];
+
+		// The entity may have been removed, or its memory reused, since the edit was queued
+		if (gamehelpers->ReferenceToEntity(edit.entref) != edit.pEntity)
+		{
+			m_Failed++;
+			continue;
+		}
+
+		if (!pEntity)
+		{
+			pEntity = edit.pEntity;
+			for (CEventAction *pAction = pOutput->m_ActionList; pAction != NULL; pAction = pAction->m_pNext)
+				m_Nodes.push_back(pAction);
+		}
+
+		if (ApplyEdit(edit))
+			applied++;
+		else
+			m_Failed++;
+	}
+
+	if (m_bRelink)
+	{
+		for (size_t i = 0; i < m_Nodes.size(); i++)
+			m_Nodes[i]->m_pNext = i + 1 < m_Nodes.size() ? m_Nodes[i + 1] : NULL;
+
+		pOutput->m_ActionList = m_Nodes.empty() ? NULL : m_Nodes[0];
+
+		for (size_t i = 0; i < m_Removed.size(); i++)
+			delete m_Removed[i];
+
+		OnOutputListChanged(pOutput);
+	}
+
+	if (!m_Retargeted.empty())
+	{
+		std::sort(m_Retargeted.begin(), m_Retargeted.end());
+		m_Retargeted.erase(std::unique(m_Retargeted.begin(), m_Retargeted.end()), m_Retargeted.end());
+
+		for (size_t i = 0; i < m_Retargeted.size(); i++)
+			OnOutputActionChanged(pEntity, pOutput, m_Retargeted[i]);
+	}
+
+	return applied;
+}
+
+bool OutputEditQueue::ApplyEdit(const Edit &edit)
+{
+	int size = (int)m_Nodes.size();
+
+	// Same rules as the immediate natives: inserts may also append, which
+	// works on an empty list; every other edit needs an existing action
+	if (edit.type == OutputEdit_Insert)
+	{
+		if (edit.index < 0 || edit.index > size)
+			return false;
+
+		CEventAction *pNewAction = new CEventAction;
+		pNewAction->m_iTarget = edit.target;
+		pNewAction->m_iTargetInput = edit.targetInput;
+		pNewAction->m_iParameter = edit.parameter;
+		pNewAction->m_flDelay = edit.delay;
+		pNewAction->m_nTimesToFire = edit.timesToFire;
+
+		m_Nodes.insert(m_Nodes.begin() + edit.index, pNewAction);
+		m_Retargeted.push_back(pNewAction);
+		m_bRelink = true;
+		return true;
+	}
+
+	if (edit.index < 0 || edit.index >= size)
+		return false;
+
+	CEventAction *pAction = m_Nodes[edit.index];
+
+	switch (edit.type)
+	{
+	case OutputEdit_SetTarget:
+		pAction->m_iTarget = edit.target;
+		m_Retargeted.push_back(pAction);
+		return true;
+
+	case OutputEdit_SetTargetInput:
+		pAction->m_iTargetInput = edit.targetInput;
+		return true;
+
+	case OutputEdit_SetParameter:
+		pAction->m_iParameter = edit.parameter;
+		return true;
+
+	case OutputEdit_SetDelay:
+		pAction->m_flDelay = edit.delay;
+		return true;
+
+	case OutputEdit_SetTimesToFire:
+		if (edit.timesToFire != 0)
+		{
+			pAction->m_nTimesToFire = edit.timesToFire;
+			return true;
+		}
+		// 0 removes the action, like SetOutputActionTimesToFire
+		// fall through
+
+	case OutputEdit_Remove:
+		m_Nodes.erase(m_Nodes.begin() + edit.index);
+		m_Retargeted.erase(std::remove(m_Retargeted.begin(), m_Retargeted.end(), pAction), m_Retargeted.end());
+		m_Removed.push_back(pAction);
+		m_bRelink = true;
+		return true;
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+cell_t SetOutputEditsDeferred(IPluginContext *pContext, const cell_t *params)
+{
+	g_EditQueue.SetDeferred(pContext, params[1] != 0);
+	return 1;
+}
+
+cell_t FlushOutputEdits(IPluginContext *pContext, const cell_t *params)
+{
+	return g_EditQueue.Drain();
+}
+
+cell_t GetPendingOutputEdits(IPluginContext *pContext, const cell_t *params)
+{
+	return g_EditQueue.Pending();
+}
+
+cell_t GetFailedOutputEdits(IPluginContext *pContext, const cell_t *params)
+{
+	return g_EditQueue.Failed();
+}
+
+const sp_nativeinfo_t g_EditQueueNatives[] =
+{
+	{ "SetOutputEditsDeferred",	SetOutputEditsDeferred },
+	{ "FlushOutputEdits",		FlushOutputEdits },
+	{ "GetPendingOutputEdits",	GetPendingOutputEdits },
+	{ "GetFailedOutputEdits",	GetFailedOutputEdits },
+	{ NULL, NULL },
+};
@@ -0,0 +1,128 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_EDITQUEUE_H_
+#define _INCLUDE_OUTPUTINFO_EDITQUEUE_H_
+
+/**
+ * @file editqueue.h
+ * @brief Per-frame queue for action edits of plugins that opted into deferred mode.
+ */
+
+#include "extension.h"
+#include "batchedit.h"
+#include <string_t.h>
+#include <vector>
+
+class CEventAction;
+class CBaseEntityOutput;
+
+/**
+ * For plugins in deferred mode, SetOutputAction*, InsertOutputAction and
+ * RemoveOutputAction only resolve the output and record the edit in a
+ * preallocated buffer. Once per frame the queue is drained grouped by output: each
+ * list is walked once into an array, the edits are applied against it in the
+ * order they were queued, and the list is relinked only if its shape changed.
+ * Indices behave exactly as if each edit had been applied immediately.
+ */
+class OutputEditQueue : public IPluginsListener
+{
+public:
+	struct Edit
+	{
+		CBaseEntityOutput *pOutput;
+		CBaseEntity *pEntity;
+		cell_t entref;
+		OutputEditType type;
+		int index;
+		string_t target;
+		string_t targetInput;
+		string_t parameter;
+		float delay;
+		int timesToFire;
+	};
+
+	OutputEditQueue();
+
+	void Init();
+	void Shutdown();
+
+	bool IsDeferred(IPluginContext *pContext);
+	void SetDeferred(IPluginContext *pContext, bool deferred);
+
+	/**
+	 * @brief Reserves the next slot, draining the queue first if it is full.
+	 * The caller fills in the edit's values.
+	 */
+	Edit *Push(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, OutputEditType type, int index);
+
+	/**
+	 * @return				Number of edits applied.
+	 */
+	int Drain();
+	void Clear();
+
+	size_t Pending() { return m_Count; }
+
+	/**
+	 * @return				Number of edits dropped when applied since the
+	 *						extension loaded: bad indices and removed entities.
+	 */
+	unsigned int Failed() { return m_Failed; }
+
+public: // IPluginsListener
+	void OnPluginUnloaded(IPlugin *plugin);
+
+private:
+	int ApplyGroup(size_t first, size_t last);
+	bool ApplyEdit(const Edit &edit);
+
+private:
+	static const size_t kCapacity = 4096;
+
+	Edit m_Edits[kCapacity];
+	size_t m_Count;
+
+	std::vector<IPluginRuntime *> m_Deferred;
+	unsigned int m_Failed;
+
+	// Scratch space for Drain, reserved up front
+	std::vector<Edit *> m_Order;
+	std::vector<CEventAction *> m_Nodes;
+	std::vector<CEventAction *> m_Retargeted;
+	std::vector<CEventAction *> m_Removed;
+	bool m_bRelink;
+};
+
+extern OutputEditQueue g_EditQueue;
+extern const sp_nativeinfo_t g_EditQueueNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_EDITQUEUE_H_
@@ -0,0 +1,231 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_ENTITYOUTPUT_H_
+#define _INCLUDE_OUTPUTINFO_ENTITYOUTPUT_H_
+
+/**
+ * @file entityoutput.h
+ * @brief Game-side layouts of entity outputs and their actions.
+ */
+
+#include "extension.h"
+#include <isaverestore.h>
+
+#if SOURCE_ENGINE == SE_CSGO && !defined PLATFORM_WINDOWS
+#include <mempool_hack.h>
+#else
+#include <mempool.h>
+#endif
+
+#include <variant_t.h>
+#include <vector>
+
+class CEventAction;
+
+/**
+ * @brief Called before an action allocated by us is returned to the pool.
+ */
+void OnEventActionFreed(CEventAction *pAction);
+
+/**
+ * @brief Allocates and frees action blocks compatible with the game's; see actionpool.h.
+ */
+void *AllocEventAction();
+void FreeEventAction(void *pMem);
+
+#define EVENT_FIRE_ALWAYS	-1
+
+class CEventAction
+{
+public:
+	CEventAction(const char *ActionData = NULL) { m_iIDStamp = ++s_iNextIDStamp; };
+
+	string_t m_iTarget; // name of the entity(s) to cause the action in
+	string_t m_iTargetInput; // the name of the action to fire
+	string_t m_iParameter; // parameter to send, 0 if none
+	float m_flDelay; // the number of seconds to wait before firing the action
+	int m_nTimesToFire; // The number of times to fire this event, or EVENT_FIRE_ALWAYS.
+
+	int m_iIDStamp;	// unique identifier stamp
+
+	static int s_iNextIDStamp; // ours, not the game's; see extension.cpp
+
+	CEventAction *m_pNext;
+
+	// allocates memory the same way the game does, see actionpool.h
+	static void *operator new(size_t stAllocateBlock)
+	{
+		return AllocEventAction();
+	}
+	static void *operator new(size_t stAllocateBlock, int nBlockUse, const char *pFileName, int nLine)
+	{
+		return AllocEventAction();
+	}
+	static void operator delete(void *pMem)
+	{
+		OnEventActionFreed((CEventAction *)pMem);
+		FreeEventAction(pMem);
+	}
+	static void operator delete( void *pMem , int nBlockUse, const char *pFileName, int nLine )
+	{
+		operator delete(pMem);
+	}
+
+	DECLARE_SIMPLE_DATADESC();
+
+};
+
+class CBaseEntityOutput
+{
+public:
+	~CBaseEntityOutput();
+
+	void ParseEventAction( const char *EventData );
+	void AddEventAction( CEventAction *pEventAction );
+
+	int Save( ISave &save );
+	int Restore( IRestore &restore, int elementCount );
+
+	int NumberOfElements( void );
+
+	float GetMaxDelay( void );
+
+	fieldtype_t ValueFieldType() { return m_Value.FieldType(); }
+
+	void FireOutput( variant_t Value, CBaseEntity *pActivator, CBaseEntity *pCaller, float fDelay = 0 );
+/*
+	/// Delete every single action in the action list.
+	void DeleteAllElements( void ) ;
+*/
+public:
+	variant_t m_Value;
+	CEventAction *m_ActionList;
+	DECLARE_SIMPLE_DATADESC();
+
+	CBaseEntityOutput() {} // this class cannot be created, only it's children
+
+private:
+	CBaseEntityOutput( CBaseEntityOutput& ); // protect from accidental copying
+};
+
+#if SOURCE_ENGINE >= SE_LEFT4DEAD
+#define TD_FIELD_OFFSET(td)		((td)->fieldOffset)
+#else
+#define TD_FIELD_OFFSET(td)		((td)->fieldOffset[TD_OFFSET_NORMAL])
+#endif
+
+/**
+ * @brief An output field of an entity class.
+ */
+struct OutputField
+{
+	const char *name;			/**< Datamap name (e.g. m_OnTrigger) */
+	const char *externalName;	/**< Map/keyvalue name (e.g. OnTrigger) */
+	int offset;					/**< Offset from the start of the entity */
+};
+
+/**
+ * @brief Collects every output field of a datamap and its base classes.
+ */
+void CollectOutputFields(datamap_t *pMap, std::vector<OutputField> &fields, int baseOffset = 0);
+
+/**
+ * @brief Returns the cached output fields of an entity's class.
+ *
+ * @return				Output fields, or nullptr if the entity has no datamap.
+ */
+const std::vector<OutputField> *GetOutputFields(CBaseEntity *pEntity);
+
+/**
+ * @brief Resolves an output's offset in a datamap by its datamap name.
+ *
+ * @return				Offset, or -1 if the name isn't an output.
+ */
+int FindOutputOffset(datamap_t *pMap, const char *pszName);
+
+/**
+ * @brief Finds an output field by its datamap name (e.g. m_OnTrigger), or
+ * else by its map name (e.g. OnTrigger) compared case-insensitively.
+ */
+const OutputField *FindOutputField(CBaseEntity *pEntity, const char *pszName);
+
+/**
+ * @brief Finds the output field at an offset from the start of the entity.
+ */
+const OutputField *FindOutputFieldByOffset(CBaseEntity *pEntity, int offset);
+
+/**
+ * @brief Returns the datamap name of an output field, or nullptr.
+ */
+const char *GetOutputName(CBaseEntity *pEntity, CBaseEntityOutput *pOutput);
+
+/**
+ * @brief Iterates every entity, including non-networked ones.
+ *
+ * @param pEntity		Previous entity, or nullptr to start.
+ * @return				Next entity, or nullptr at the end.
+ */
+CBaseEntity *NextEntity(CBaseEntity *pEntity);
+
+/**
+ * @brief Resolves a named output field of an entity.
+ *
+ * @param pEntity		Entity to use.
+ * @param pOutput		Datamap name of the output (e.g. m_OnTrigger).
+ * @return				Output, or nullptr if the entity has no such output.
+ */
+CBaseEntityOutput *GetOutput(CBaseEntity *pEntity, const char *pOutput);
+
+/**
+ * @brief Returns a counter that changes whenever we insert into or remove from
+ * an output's action list, so cursors into the list can tell it was modified.
+ */
+unsigned int GetOutputListVersion(CBaseEntityOutput *pOutput);
+
+/**
+ * @brief Must be called after every insertion into or removal from an action list.
+ */
+void OnOutputListChanged(CBaseEntityOutput *pOutput);
+
+/**
+ * @brief Detaches an output's action list and frees every action in it.
+ *
+ * @return				Number of actions freed.
+ */
+int FreeOutputActions(CBaseEntityOutput *pOutput);
+
+/**
+ * @brief Must be called after we insert an action or change its target.
+ */
+void OnOutputActionChanged(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction);
+
+#endif // _INCLUDE_OUTPUTINFO_ENTITYOUTPUT_H_
@@ -0,0 +1,190 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "eventqueue.h"
+
+/**
+ * @file eventqueue.cpp
+ * @brief Inspection and bulk cancellation of the game's pending I/O events.
+ */
+
+OutputEventQueue g_OutputEventQueue;
+
+void OutputEventQueue::Init(IGameConfig *pGameConf)
+{
+	if (!pGameConf->GetAddress("g_EventQueue", reinterpret_cast<void **>(&m_pQueue)))
+		m_pQueue = nullptr;
+}
+
+static cell_t HandleToReference(const CBaseHandle &hndl)
+{
+	if (!hndl.IsValid())
+		return -1;
+
+	return hndl.ToInt() | (1<<31);
+}
+
+static bool IsCancelled(const EventQueuePrioritizedEvent_t *pEvent)
+{
+	return pEvent->m_iTarget == NULL_STRING && !pEvent->m_pEntTarget.IsValid();
+}
+
+int OutputEventQueue::Capture()
+{
+	m_Events.clear();
+
+	for (EventQueuePrioritizedEvent_t *pEvent = m_pQueue->m_Events.m_pNext; pEvent != NULL; pEvent = pEvent->m_pNext)
+	{
+		if (IsCancelled(pEvent))
+			continue;
+
+		Event event;
+		event.fireTime = pEvent->m_flFireTime;
+		event.target = pEvent->m_iTarget;
+		event.targetInput = pEvent->m_iTargetInput;
+		event.caller = HandleToReference(pEvent->m_pCaller);
+		event.activator = HandleToReference(pEvent->m_pActivator);
+		event.entTarget = HandleToReference(pEvent->m_pEntTarget);
+		m_Events.push_back(event);
+	}
+
+	return (int)m_Events.size();
+}
+
+int OutputEventQueue::Cancel(const char *pszTarget, const char *pszInput, cell_t callerRef)
+{
+	size_t targetLength = strlen(pszTarget);
+	bool prefix = targetLength > 0 && pszTarget[targetLength - 1] == '*';
+	if (prefix)
+		targetLength--;
+
+	int cancelled = 0;
+	for (EventQueuePrioritizedEvent_t *pEvent = m_pQueue->m_Events.m_pNext; pEvent != NULL; pEvent = pEvent->m_pNext)
+	{
+		if (IsCancelled(pEvent))
+			continue;
+
+		if (pszTarget[0])
+		{
+			const char *pszEventTarget = pEvent->m_iTarget.ToCStr();
+			if (prefix ? strnicmp(pszEventTarget, pszTarget, targetLength) != 0 : stricmp(pszEventTarget, pszTarget) != 0)
+				continue;
+		}
+
+		if (pszInput[0] && stricmp(pEvent->m_iTargetInput.ToCStr(), pszInput) != 0)
+			continue;
+
+		if (callerRef != -1 && HandleToReference(pEvent->m_pCaller) != callerRef)
+			continue;
+
+		pEvent->m_iTarget = NULL_STRING;
+		pEvent->m_iTargetInput = NULL_STRING;
+		pEvent->m_pEntTarget.Term();
+		cancelled++;
+	}
+
+	return cancelled;
+}
+
+static bool CheckEventQueue(IPluginContext *pContext)
+{
+	if (!g_OutputEventQueue.IsAvailable())
+	{
+		pContext->ThrowNativeError("The event queue is unavailable, g_EventQueue is missing from gamedata");
+		return false;
+	}
+
+	return true;
+}
+
+cell_t GetPendingOutputEvents(IPluginContext *pContext, const cell_t *params)
+{
+	if (!CheckEventQueue(pContext))
+		return 0;
+
+	return g_OutputEventQueue.Capture();
+}
+
+cell_t GetPendingOutputEvent(IPluginContext *pContext, const cell_t *params)
+{
+	if (params[1] < 0 || params[1] >= (cell_t)g_OutputEventQueue.m_Events.size())
+	{
+		return pContext->ThrowNativeError("Invalid event %d (count: %d)", params[1], (int)g_OutputEventQueue.m_Events.size());
+	}
+
+	const OutputEventQueue::Event &event = g_OutputEventQueue.m_Events[params[1]];
+
+	pContext->StringToLocal(params[2], params[3], event.target.ToCStr());
+	pContext->StringToLocal(params[4], params[5], event.targetInput.ToCStr());
+
+	cell_t *pFireTime, *pCaller, *pActivator;
+	pContext->LocalToPhysAddr(params[6], &pFireTime);
+	pContext->LocalToPhysAddr(params[7], &pCaller);
+	pContext->LocalToPhysAddr(params[8], &pActivator);
+
+	*pFireTime = sp_ftoc(event.fireTime);
+	*pCaller = event.caller == -1 ? -1 : gamehelpers->ReferenceToBCompatRef(event.caller);
+	*pActivator = event.activator == -1 ? -1 : gamehelpers->ReferenceToBCompatRef(event.activator);
+
+	return event.entTarget == -1 ? -1 : gamehelpers->ReferenceToBCompatRef(event.entTarget);
+}
+
+cell_t CancelOutputEvents(IPluginContext *pContext, const cell_t *params)
+{
+	if (!CheckEventQueue(pContext))
+		return 0;
+
+	char *pTarget, *pInput;
+	pContext->LocalToString(params[1], &pTarget);
+	pContext->LocalToString(params[2], &pInput);
+
+	cell_t callerRef = -1;
+	if (params[3] != -1)
+	{
+		CBaseEntity *pCaller = gamehelpers->ReferenceToEntity(params[3]);
+		if (!pCaller)
+		{
+			return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[3]), params[3]);
+		}
+
+		callerRef = gamehelpers->EntityToReference(pCaller);
+	}
+
+	return g_OutputEventQueue.Cancel(pTarget, pInput, callerRef);
+}
+
+const sp_nativeinfo_t g_EventQueueNatives[] =
+{
+	{ "GetPendingOutputEvents",		GetPendingOutputEvents },
+	{ "GetPendingOutputEvent",		GetPendingOutputEvent },
+	{ "CancelOutputEvents",			CancelOutputEvents },
+	{ NULL, NULL },
+};
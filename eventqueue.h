@@ -0,0 +1,124 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_EVENTQUEUE_H_
+#define _INCLUDE_OUTPUTINFO_EVENTQUEUE_H_
+
+/**
+ * @file eventqueue.h
+ * @brief Inspection and bulk cancellation of the game's pending I/O events.
+ */
+
+#include "extension.h"
+#include <basehandle.h>
+#include <string_t.h>
+#include <variant_t.h>
+#include <vector>
+
+struct EventQueuePrioritizedEvent_t
+{
+	float m_flFireTime;
+	string_t m_iTarget;
+	string_t m_iTargetInput;
+	CBaseHandle m_pActivator;
+	CBaseHandle m_pCaller;
+	int m_iOutputID;
+	CBaseHandle m_pEntTarget;  // a pointer to the entity to target; overrides m_iTarget
+
+	variant_t m_VariantValue;	// variable-type parameter
+
+	EventQueuePrioritizedEvent_t *m_pNext;
+	EventQueuePrioritizedEvent_t *m_pPrev;
+};
+
+// DECLARE_SIMPLE_DATADESC adds no virtuals, so m_Events sits at offset 0
+class CEventQueue
+{
+public:
+	EventQueuePrioritizedEvent_t m_Events;	// list head, m_Events.m_pNext is the first event
+	int m_iListCount;
+};
+
+/**
+ * Events are sorted by fire time in the game's g_EventQueue, found through
+ * gamedata. They belong to the game's fixed size allocator, so cancelling
+ * doesn't unlink them: the target and input are cleared instead, and the
+ * game drops the event when it comes up since no entity matches it.
+ */
+class OutputEventQueue
+{
+public:
+	struct Event
+	{
+		float fireTime;
+		string_t target;
+		string_t targetInput;
+		cell_t caller;			/**< Entity references, or -1 */
+		cell_t activator;
+		cell_t entTarget;
+	};
+
+	OutputEventQueue() : m_pQueue(nullptr) {}
+
+	void Init(IGameConfig *pGameConf);
+
+	bool IsAvailable() { return m_pQueue != nullptr; }
+
+	/**
+	 * @brief Copies every pending event into m_Events, in firing order.
+	 *
+	 * @return				Number of events.
+	 */
+	int Capture();
+
+	/**
+	 * @brief Cancels every pending event matching all given filters.
+	 *
+	 * @param pszTarget		Target name, a trailing * matches a prefix; or empty.
+	 * @param pszInput		Target input; or empty.
+	 * @param callerRef		Entity reference of the caller, or -1.
+	 * @return				Number of events cancelled.
+	 */
+	int Cancel(const char *pszTarget, const char *pszInput, cell_t callerRef);
+
+	void Clear() { m_Events.clear(); }
+
+public:
+	std::vector<Event> m_Events;
+
+private:
+	CEventQueue *m_pQueue;
+};
+
+extern OutputEventQueue g_OutputEventQueue;
+extern const sp_nativeinfo_t g_EventQueueNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_EVENTQUEUE_H_
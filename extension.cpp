@@ -30,6 +30,25 @@
  */
 
 #include "extension.h"
+#include "entityoutput.h"
+#include "actioniterator.h"
+#include "actionpool.h"
+#include "actionrefs.h"
+#include "batchedit.h"
+#include "benchmark.h"
+#include "editqueue.h"
+#include "eventqueue.h"
+#include "firehooks.h"
+#include "lumpgraph.h"
+#include "outputgraph.h"
+#include "outputinfoapi.h"
+#include "outputkey.h"
+#include "profiler.h"
+#include "rules.h"
+#include "snapshot.h"
+#include "stringpool.h"
+#include "targetindex.h"
+#include "throttle.h"
 
 /**
  * @file extension.cpp
@@ -40,183 +59,309 @@ Outputinfo g_Outputinfo;		/**< Global singleton for extension's main interface *
 
 SMEXT_LINK(&g_Outputinfo);
 
-#include <isaverestore.h>
-
-#ifdef PLATFORM_WINDOWS
-#include <mempool.h>
-#else
-#include <mempool_hack.h>
-#endif
-
-#include <variant_t.h>
+#include <iserverunknown.h>
 #include <itoolentity.h>
+#include <sm_stringhashmap.h>
+#include <ctype.h>
 
-IServerTools *servertools = nullptr;
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
-#if SOURCE_ENGINE == SE_CSGO
-#ifdef PLATFORM_WINDOWS
-typedef int* (*AllocFunction)();
-#else
-typedef int* (*AllocFunction)(void*);
-#endif
+IServerTools *servertools = nullptr;
 
-CUtlMemoryPool *g_pEntityListPool = nullptr;
-AllocFunction g_EntityListPool_Alloc = nullptr;
-#endif
+// Stamps for actions we create start far above the game's own counter so
+// the two never hand out the same stamp.
+int CEventAction::s_iNextIDStamp = 0x40000000;
 
-#define EVENT_FIRE_ALWAYS	-1
+void CBaseEntityOutput::AddEventAction(CEventAction *pEventAction)
+{
+	pEventAction->m_pNext = m_ActionList;
+	m_ActionList = pEventAction;
+}
 
-class CEventAction
+int CBaseEntityOutput::NumberOfElements(void)
 {
-public:
-	CEventAction(const char *ActionData = NULL) { m_iIDStamp = 0; };
+	int count = 0;
+	for (CEventAction *ev = m_ActionList; ev != NULL; ev = ev->m_pNext)
+	{
+		count++;
+	}
 
-	string_t m_iTarget; // name of the entity(s) to cause the action in
-	string_t m_iTargetInput; // the name of the action to fire
-	string_t m_iParameter; // parameter to send, 0 if none
-	float m_flDelay; // the number of seconds to wait before firing the action
-	int m_nTimesToFire; // The number of times to fire this event, or EVENT_FIRE_ALWAYS.
+	return count;
+}
 
-	int m_iIDStamp;	// unique identifier stamp
+std::unordered_map<CBaseEntityOutput *, unsigned int> g_OutputListVersions;
 
-	static int s_iNextIDStamp;
+unsigned int GetOutputListVersion(CBaseEntityOutput *pOutput)
+{
+	auto it = g_OutputListVersions.find(pOutput);
+	return it != g_OutputListVersions.end() ? it->second : 0;
+}
 
-	CEventAction *m_pNext;
+void OnOutputListChanged(CBaseEntityOutput *pOutput)
+{
+	g_OutputListVersions[pOutput]++;
+	g_OutputGraph.OnOutputChanged(pOutput);
+}
 
-	// allocates memory from engine.MPool/g_EntityListPool
-#if SOURCE_ENGINE == SE_CSGO
-	static void *operator new(size_t stAllocateBlock)
-	{
-#ifdef PLATFORM_WINDOWS
-		return g_EntityListPool_Alloc();
-#else
-		return g_EntityListPool_Alloc( g_pEntityListPool );
-#endif
-	}
-	static void *operator new(size_t stAllocateBlock, int nBlockUse, const char *pFileName, int nLine)
-	{
-#ifdef PLATFORM_WINDOWS
-		return g_EntityListPool_Alloc();
-#else
-		return g_EntityListPool_Alloc( g_pEntityListPool );
-#endif
-	}
-	static void operator delete(void *pMem)
+int FreeOutputActions(CBaseEntityOutput *pOutput)
+{
+	CEventAction *pAction = pOutput->m_ActionList;
+	if (pAction == NULL)
+		return 0;
+
+	pOutput->m_ActionList = NULL;
+
+	int count = 0;
+	while (pAction != NULL)
 	{
-		g_pEntityListPool->Free(pMem);
+		CEventAction *pNext = pAction->m_pNext;
+		delete pAction;
+		pAction = pNext;
+		count++;
 	}
-	static void operator delete( void *pMem , int nBlockUse, const char *pFileName, int nLine )
+
+	OnOutputListChanged(pOutput);
+	return count;
+}
+
+int FreeEntityOutputActions(CBaseEntity *pEntity)
+{
+	const std::vector<OutputField> *pFields = GetOutputFields(pEntity);
+	if (!pFields)
+		return 0;
+
+	int count = 0;
+	for (size_t i = 0; i < pFields->size(); i++)
+		count += FreeOutputActions((CBaseEntityOutput *)((intptr_t)pEntity + (*pFields)[i].offset));
+
+	return count;
+}
+
+void CollectOutputFields(datamap_t *pMap, std::vector<OutputField> &fields, int baseOffset)
+{
+	for (; pMap != NULL; pMap = pMap->baseMap)
 	{
-		operator delete(pMem);
+		for (int i = 0; i < pMap->dataNumFields; i++)
+		{
+			typedescription_t *pTypeDesc = &pMap->dataDesc[i];
+			if (pTypeDesc->fieldName == NULL)
+				continue;
+
+			int offset = baseOffset + TD_FIELD_OFFSET(pTypeDesc);
+
+			if (pTypeDesc->flags & FTYPEDESC_OUTPUT)
+			{
+				OutputField field;
+				field.name = pTypeDesc->fieldName;
+				field.externalName = pTypeDesc->externalName ? pTypeDesc->externalName : pTypeDesc->fieldName;
+				field.offset = offset;
+				fields.push_back(field);
+			}
+			else if (pTypeDesc->fieldType == FIELD_EMBEDDED && pTypeDesc->td != NULL)
+			{
+				CollectOutputFields(pTypeDesc->td, fields, offset);
+			}
+		}
 	}
-#endif
+}
+
+static void LowerName(const char *pszName, char *buffer, size_t maxlength)
+{
+	size_t i = 0;
+	for (; i < maxlength - 1 && pszName[i] != '\0'; i++)
+		buffer[i] = tolower((unsigned char)pszName[i]);
 
-	DECLARE_SIMPLE_DATADESC();
+	buffer[i] = '\0';
+}
 
+/**
+ * Output fields of one datamap, with every way we look them up.
+ * Names plugins asked for are cached with the field they resolved to, or -1
+ * if they aren't an output, so repeated misses don't scan the fields either.
+ */
+struct OutputFieldSet
+{
+	std::vector<OutputField> fields;
+	StringHashMap<int> names;			/**< Datamap names looked up so far */
+	StringHashMap<int> externalNames;	/**< Lower-cased map names of every field */
+	std::vector<std::pair<int, int>> offsets;	/**< (offset, field), sorted */
 };
 
-class CBaseEntityOutput
+/**
+ * Every module's output lookups go through here, keyed by datamap.
+ * Datamaps are static data of the game binary, so the fields are never
+ * flushed; the names plugins looked up are, on map change.
+ */
+class OutputFieldCache
 {
 public:
-	~CBaseEntityOutput();
-
-	void ParseEventAction( const char *EventData );
-	void AddEventAction( CEventAction *pEventAction );
-
-	int Save( ISave &save );
-	int Restore( IRestore &restore, int elementCount );
-
-	int NumberOfElements( void );
+	OutputFieldCache() : m_Hits(0), m_Misses(0), m_NegativeHits(0) {}
 
-	float GetMaxDelay( void );
+	OutputFieldSet *Get(datamap_t *pMap);
+	const OutputField *FindByName(datamap_t *pMap, const char *pName);
 
-	fieldtype_t ValueFieldType() { return m_Value.FieldType(); }
+	void Clear();
+	size_t Size();
 
-	void FireOutput( variant_t Value, CBaseEntity *pActivator, CBaseEntity *pCaller, float fDelay = 0 );
-/*
-	/// Delete every single action in the action list.
-	void DeleteAllElements( void ) ;
-*/
 public:
-	variant_t m_Value;
-	CEventAction *m_ActionList;
-	DECLARE_SIMPLE_DATADESC();
-
-	CBaseEntityOutput() {} // this class cannot be created, only it's children
+	unsigned int m_Hits;
+	unsigned int m_Misses;
+	unsigned int m_NegativeHits;
 
 private:
-	CBaseEntityOutput( CBaseEntityOutput& ); // protect from accidental copying
+	std::unordered_map<datamap_t *, std::unique_ptr<OutputFieldSet>> m_Sets;
 };
 
-void CBaseEntityOutput::AddEventAction(CEventAction *pEventAction)
+OutputFieldCache g_OutputFieldCache;
+
+OutputFieldSet *OutputFieldCache::Get(datamap_t *pMap)
 {
-	pEventAction->m_pNext = m_ActionList;
-	m_ActionList = pEventAction;
+	std::unique_ptr<OutputFieldSet> &pSet = m_Sets[pMap];
+	if (pSet)
+		return pSet.get();
+
+	pSet.reset(new OutputFieldSet);
+	CollectOutputFields(pMap, pSet->fields);
+
+	for (size_t i = 0; i < pSet->fields.size(); i++)
+	{
+		const OutputField &field = pSet->fields[i];
+
+		char key[256];
+		LowerName(field.externalName, key, sizeof(key));
+		pSet->externalNames.insert(key, (int)i);
+
+		pSet->offsets.push_back(std::make_pair(field.offset, (int)i));
+	}
+
+	std::sort(pSet->offsets.begin(), pSet->offsets.end());
+	return pSet.get();
 }
 
-int CBaseEntityOutput::NumberOfElements(void)
+const OutputField *OutputFieldCache::FindByName(datamap_t *pMap, const char *pName)
 {
-	int count = 0;
-	for (CEventAction *ev = m_ActionList; ev != NULL; ev = ev->m_pNext)
+	OutputFieldSet *pSet = Get(pMap);
+
+	int index;
+	if (pSet->names.retrieve(pName, &index))
 	{
-		count++;
+		if (index == -1)
+		{
+			m_NegativeHits++;
+			return nullptr;
+		}
+
+		m_Hits++;
+		return &pSet->fields[index];
 	}
 
-	return count;
+	m_Misses++;
+
+	index = -1;
+	for (size_t i = 0; i < pSet->fields.size(); i++)
+	{
+		if (strcmp(pSet->fields[i].name, pName) == 0)
+		{
+			index = (int)i;
+			break;
+		}
+	}
+
+	pSet->names.insert(pName, index);
+	return index == -1 ? nullptr : &pSet->fields[index];
 }
 
-inline int GetDataMapOffset(CBaseEntity *pEnt, const char *pName)
+void OutputFieldCache::Clear()
 {
-	datamap_t *pMap = gamehelpers->GetDataMap(pEnt);
-	if(!pMap)
-		return -1;
+	for (auto it = m_Sets.begin(); it != m_Sets.end(); ++it)
+		it->second->names.clear();
+}
 
-	typedescription_t *pTypeDesc = gamehelpers->FindInDataMap(pMap, pName);
+size_t OutputFieldCache::Size()
+{
+	size_t size = 0;
+	for (auto it = m_Sets.begin(); it != m_Sets.end(); ++it)
+		size += it->second->names.elements();
 
-	if(pTypeDesc == NULL)
-		return -1;
+	return size;
+}
+
+const std::vector<OutputField> *GetOutputFields(CBaseEntity *pEntity)
+{
+	datamap_t *pMap = gamehelpers->GetDataMap(pEntity);
+	if (!pMap)
+		return nullptr;
 
-#if SOURCE_ENGINE >= SE_LEFT4DEAD
-	return pTypeDesc->fieldOffset;
-#else
-	return pTypeDesc->fieldOffset[TD_OFFSET_NORMAL];
-#endif
+	return &g_OutputFieldCache.Get(pMap)->fields;
 }
 
-string_t AllocPooledString(const char *pszValue)
+int FindOutputOffset(datamap_t *pMap, const char *pszName)
 {
-	// This is admittedly a giant hack, but it's a relatively safe method for
-	// inserting a string into the game's string pool that isn't likely to break.
-	//
-	// We find the first valid ent (should always be worldspawn), save off it's
-	// current targetname string_t, set it to our string to insert via SetKeyValue,
-	// read back the new targetname value, restore the old value, and return the new one.
+	const OutputField *pField = g_OutputFieldCache.FindByName(pMap, pszName);
+	return pField ? pField->offset : -1;
+}
 
-	CBaseEntity *pEntity = reinterpret_cast<IServerUnknown *>(servertools->FirstEntity())->GetBaseEntity();
-	auto *pDataMap = gamehelpers->GetDataMap(pEntity);
-	assert(pDataMap);
+const OutputField *FindOutputField(CBaseEntity *pEntity, const char *pszName)
+{
+	datamap_t *pMap = gamehelpers->GetDataMap(pEntity);
+	if (!pMap)
+		return nullptr;
 
-	static int offset = -1;
-	if (offset == -1)
-	{
-		sm_datatable_info_t info;
-		bool found = gamehelpers->FindDataMapInfo(pDataMap, "m_iName", &info);
-		assert(found);
-		offset = info.actual_offset;
-	}
+	const OutputField *pField = g_OutputFieldCache.FindByName(pMap, pszName);
+	if (pField)
+		return pField;
+
+	char key[256];
+	LowerName(pszName, key, sizeof(key));
+
+	OutputFieldSet *pSet = g_OutputFieldCache.Get(pMap);
+	int index;
+	if (!pSet->externalNames.retrieve(key, &index))
+		return nullptr;
+
+	return &pSet->fields[index];
+}
+
+const OutputField *FindOutputFieldByOffset(CBaseEntity *pEntity, int offset)
+{
+	datamap_t *pMap = gamehelpers->GetDataMap(pEntity);
+	if (!pMap)
+		return nullptr;
+
+	OutputFieldSet *pSet = g_OutputFieldCache.Get(pMap);
+	auto it = std::lower_bound(pSet->offsets.begin(), pSet->offsets.end(), std::make_pair(offset, 0));
+	if (it == pSet->offsets.end() || it->first != offset)
+		return nullptr;
+
+	return &pSet->fields[it->second];
+}
+
+const char *GetOutputName(CBaseEntity *pEntity, CBaseEntityOutput *pOutput)
+{
+	const OutputField *pField = FindOutputFieldByOffset(pEntity, (int)((intptr_t)pOutput - (intptr_t)pEntity));
+	return pField ? pField->name : nullptr;
+}
 
-	string_t *pProp = (string_t *) ((intp) pEntity + offset);
-	string_t backup = *pProp;
-	servertools->SetKeyValue(pEntity, "targetname", pszValue);
-	string_t newString = *pProp;
-	*pProp = backup;
+CBaseEntity *NextEntity(CBaseEntity *pEntity)
+{
+	void *pNext = pEntity ? servertools->NextEntity(pEntity) : servertools->FirstEntity();
+	if (!pNext)
+		return nullptr;
 
-	return newString;
+	return reinterpret_cast<IServerUnknown *>(pNext)->GetBaseEntity();
 }
 
-inline CBaseEntityOutput *GetOutput(CBaseEntity *pEntity, const char *pOutput)
+CBaseEntityOutput *GetOutput(CBaseEntity *pEntity, const char *pOutput)
 {
-	int offset = GetDataMapOffset(pEntity, pOutput);
+	datamap_t *pMap = gamehelpers->GetDataMap(pEntity);
+	if(!pMap)
+		return nullptr;
+
+	int offset = FindOutputOffset(pMap, pOutput);
 
 	if(offset == -1)
 		return nullptr;
@@ -224,18 +369,13 @@ inline CBaseEntityOutput *GetOutput(CBaseEntity *pEntity, const char *pOutput)
 	return (CBaseEntityOutput *)((intptr_t)pEntity + offset);
 }
 
+template <OutputParamReader Read>
 cell_t GetOutputActionCount(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
-
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
-	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
-	}
-
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
 	if(pEntityOutput == NULL)
 		return 0;
@@ -243,18 +383,13 @@ cell_t GetOutputActionCount(IPluginContext *pContext, const cell_t *params)
 	return pEntityOutput->NumberOfElements();
 }
 
+template <OutputParamReader Read>
 cell_t GetOutputActionTarget(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
-
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
-	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
-	}
-
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
 	if(pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
 		return 0;
@@ -273,20 +408,27 @@ cell_t GetOutputActionTarget(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+template <OutputParamReader Read>
 cell_t SetOutputActionTarget(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	if (pEntityOutput == NULL)
+		return 0;
+
+	// Indices are checked when the queue applies the edit; an insert queued before may fill the list
+	if (g_EditQueue.IsDeferred(pContext))
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		char *szTarget;
+		pContext->LocalToString(params[4], &szTarget);
+		g_EditQueue.Push(pEntity, pEntityOutput, OutputEdit_SetTarget, params[3])->target = AllocPooledString(szTarget);
+		return 1;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
-
-	if(pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+	if (pEntityOutput->m_ActionList == NULL)
 		return 0;
 
 	CEventAction *pAction = pEntityOutput->m_ActionList;
@@ -301,22 +443,18 @@ cell_t SetOutputActionTarget(IPluginContext *pContext, const cell_t *params)
 	char *szTarget;
 	pContext->LocalToString(params[4], &szTarget);
 	pAction->m_iTarget = AllocPooledString(szTarget);
+	OnOutputActionChanged(pEntity, pEntityOutput, pAction);
 
 	return 1;
 }
 
+template <OutputParamReader Read>
 cell_t GetOutputActionTargetInput(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
-
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
-	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
-	}
-
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
 	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
 		return 0;
@@ -335,20 +473,26 @@ cell_t GetOutputActionTargetInput(IPluginContext *pContext, const cell_t *params
 	return 1;
 }
 
+template <OutputParamReader Read>
 cell_t SetOutputActionTargetInput(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	if (pEntityOutput == NULL)
+		return 0;
+
+	if (g_EditQueue.IsDeferred(pContext))
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		char *szTargetInput;
+		pContext->LocalToString(params[4], &szTargetInput);
+		g_EditQueue.Push(pEntity, pEntityOutput, OutputEdit_SetTargetInput, params[3])->targetInput = AllocPooledString(szTargetInput);
+		return 1;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
-
-	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+	if (pEntityOutput->m_ActionList == NULL)
 		return 0;
 
 	CEventAction *pAction = pEntityOutput->m_ActionList;
@@ -367,18 +511,13 @@ cell_t SetOutputActionTargetInput(IPluginContext *pContext, const cell_t *params
 	return 1;
 }
 
+template <OutputParamReader Read>
 cell_t GetOutputActionParameter(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
-
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
-	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
-	}
-
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
 	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
 		return 0;
@@ -397,20 +536,26 @@ cell_t GetOutputActionParameter(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+template <OutputParamReader Read>
 cell_t SetOutputActionParameter(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	if (pEntityOutput == NULL)
+		return 0;
+
+	if (g_EditQueue.IsDeferred(pContext))
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		char *szParameter;
+		pContext->LocalToString(params[4], &szParameter);
+		g_EditQueue.Push(pEntity, pEntityOutput, OutputEdit_SetParameter, params[3])->parameter = AllocPooledString(szParameter);
+		return 1;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
-
-	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+	if (pEntityOutput->m_ActionList == NULL)
 		return 0;
 
 	CEventAction *pAction = pEntityOutput->m_ActionList;
@@ -429,18 +574,77 @@ cell_t SetOutputActionParameter(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
-cell_t GetOutputActionDelay(IPluginContext *pContext, const cell_t *params)
+template <OutputParamReader Read>
+static CEventAction *GetOutputActionAt(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return NULL;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+		return NULL;
+
+	CEventAction *pAction = pEntityOutput->m_ActionList;
+	for(int i = 0; i < params[3]; i++)
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		if( pAction->m_pNext == NULL)
+			return NULL;
+
+		pAction = pAction->m_pNext;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+	return pAction;
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputActionTargetId(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = GetOutputActionAt<Read>(pContext, params);
+	if (!pAction)
+		return 0;
+
+	return PooledStringId(pAction->m_iTarget);
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputActionTargetInputId(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = GetOutputActionAt<Read>(pContext, params);
+	if (!pAction)
+		return 0;
+
+	return PooledStringId(pAction->m_iTargetInput);
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputActionParameterId(IPluginContext *pContext, const cell_t *params)
+{
+	CEventAction *pAction = GetOutputActionAt<Read>(pContext, params);
+	if (!pAction)
+		return 0;
+
+	return PooledStringId(pAction->m_iParameter);
+}
+
+cell_t InternOutputString(IPluginContext *pContext, const cell_t *params)
+{
+	char *pString;
+	pContext->LocalToString(params[1], &pString);
+
+	if (pString[0] == '\0')
+		return 0;
+
+	return PooledStringId(AllocPooledString(pString));
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputActionDelay(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
 	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
 		return -1.0f;
@@ -457,20 +661,24 @@ cell_t GetOutputActionDelay(IPluginContext *pContext, const cell_t *params)
 	return sp_ftoc(pAction->m_flDelay);
 }
 
+template <OutputParamReader Read>
 cell_t SetOutputActionDelay(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	if (pEntityOutput == NULL)
+		return 0;
+
+	if (g_EditQueue.IsDeferred(pContext))
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		g_EditQueue.Push(pEntity, pEntityOutput, OutputEdit_SetDelay, params[3])->delay = sp_ctof(params[4]);
+		return 1;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
-
-	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+	if (pEntityOutput->m_ActionList == NULL)
 		return 0;
 
 	CEventAction *pAction = pEntityOutput->m_ActionList;
@@ -486,18 +694,13 @@ cell_t SetOutputActionDelay(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+template <OutputParamReader Read>
 cell_t GetOutputActionTimesToFire(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
-
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
-	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
-	}
-
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
 	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
 		return 0;
@@ -514,20 +717,24 @@ cell_t GetOutputActionTimesToFire(IPluginContext *pContext, const cell_t *params
 	return pAction->m_nTimesToFire;
 }
 
+template <OutputParamReader Read>
 cell_t SetOutputActionTimesToFire(IPluginContext *pContext, const cell_t *params)
 {
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	if (pEntityOutput == NULL)
+		return 0;
+
+	if (g_EditQueue.IsDeferred(pContext))
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		g_EditQueue.Push(pEntity, pEntityOutput, OutputEdit_SetTimesToFire, params[3])->timesToFire = params[4];
+		return 1;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
-
-	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+	if (pEntityOutput->m_ActionList == NULL)
 		return 0;
 
 	CEventAction *pPrev = nullptr;
@@ -553,6 +760,7 @@ cell_t SetOutputActionTimesToFire(IPluginContext *pContext, const cell_t *params
 		}
 
 		delete pAction;
+		OnOutputListChanged(pEntityOutput);
 	}
 	else
 	{
@@ -562,21 +770,24 @@ cell_t SetOutputActionTimesToFire(IPluginContext *pContext, const cell_t *params
 	return 1;
 }
 
+template <OutputParamReader Read>
 cell_t RemoveOutputAction(IPluginContext *pContext, const cell_t *params)
 {
-#if SOURCE_ENGINE == SE_CSGO
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	if (pEntityOutput == NULL)
+		return 0;
+
+	if (g_EditQueue.IsDeferred(pContext))
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		g_EditQueue.Push(pEntity, pEntityOutput, OutputEdit_Remove, params[3]);
+		return 1;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
-
-	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+	if (pEntityOutput->m_ActionList == NULL)
 		return 0;
 
 	CEventAction *pPrev = nullptr;
@@ -600,29 +811,53 @@ cell_t RemoveOutputAction(IPluginContext *pContext, const cell_t *params)
 	}
 
 	delete pAction;
+	OnOutputListChanged(pEntityOutput);
 
 	return 1;
-#else
-	return pContext->ThrowNativeError( "This feature is unsupported on this version of the engine." );
-#endif
 }
 
+template <OutputParamReader Read>
 cell_t InsertOutputAction(IPluginContext *pContext, const cell_t *params)
 {
-#if SOURCE_ENGINE == SE_CSGO
-	char *pOutput;
-	pContext->LocalToString(params[2], &pOutput);
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
-	if (!pEntity)
+	// An empty list is fine: index 0 adds the first action
+	if (pEntityOutput == NULL || params[8] < 0)
+		return 0;
+
+	if (g_EditQueue.IsDeferred(pContext))
 	{
-		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		OutputEditQueue::Edit *pEdit = g_EditQueue.Push(pEntity, pEntityOutput, OutputEdit_Insert, params[8]);
+		char *buffer;
+
+		pContext->LocalToString(params[3], &buffer);
+		pEdit->target = AllocPooledString(buffer);
+
+		pContext->LocalToString(params[4], &buffer);
+		pEdit->targetInput = AllocPooledString(buffer);
+
+		pContext->LocalToString(params[5], &buffer);
+		pEdit->parameter = AllocPooledString(buffer);
+
+		pEdit->delay = sp_ctof(params[6]);
+		pEdit->timesToFire = params[7];
+		return 1;
 	}
 
-	CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+	// Find the insertion point before allocating, so a bad index has nothing to free.
+	// An index equal to the action count appends.
+	CEventAction *pPrev = nullptr;
+	for( int i = 0; i < params[8]; i++ )
+	{
+		CEventAction *pNext = pPrev ? pPrev->m_pNext : pEntityOutput->m_ActionList;
+		if( pNext == NULL )
+			return 0;
 
-	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
-		return 0;
+		pPrev = pNext;
+	}
 
 	CEventAction *pNewAction = new CEventAction;
 	char *buffer;
@@ -640,101 +875,519 @@ cell_t InsertOutputAction(IPluginContext *pContext, const cell_t *params)
 
 	pNewAction->m_nTimesToFire = params[7];
 
-	if(params[8] == 0)
+	if(pPrev == nullptr)
 	{
 		pEntityOutput->AddEventAction(pNewAction);
 	}
 	else
 	{
-		CEventAction *pPrev = nullptr;
-		CEventAction *pAction = pEntityOutput->m_ActionList;
-		for( int i = 0; i < params[3]; i++ )
+		pNewAction->m_pNext = pPrev->m_pNext;
+		pPrev->m_pNext = pNewAction;
+	}
+
+	OnOutputListChanged(pEntityOutput);
+	OnOutputActionChanged(pEntity, pEntityOutput, pNewAction);
+
+	return 1;
+}
+
+/**
+ * Copy of every action of an output, taken in a single walk of m_ActionList.
+ * Strings are packed into one buffer so the snapshot stays valid after the
+ * entity or the game's string pool go away.
+ */
+class OutputActionList
+{
+public:
+	struct Action
+	{
+		size_t target;
+		size_t targetinput;
+		size_t parameter;
+		float delay;
+		int timestofire;
+	};
+
+public:
+	explicit OutputActionList(CBaseEntityOutput *pEntityOutput)
+	{
+		for (CEventAction *pAction = pEntityOutput->m_ActionList; pAction != NULL; pAction = pAction->m_pNext)
 		{
-			if( pAction->m_pNext == NULL )
-				return 0;
+			Action action;
+			action.target = AddString(pAction->m_iTarget.ToCStr());
+			action.targetinput = AddString(pAction->m_iTargetInput.ToCStr());
+			action.parameter = AddString(pAction->m_iParameter.ToCStr());
+			action.delay = pAction->m_flDelay;
+			action.timestofire = pAction->m_nTimesToFire;
+			m_Actions.push_back(action);
+		}
+	}
+
+	const char *GetString(size_t offset) const
+	{
+		return m_Strings.c_str() + offset;
+	}
+
+private:
+	size_t AddString(const char *pszValue)
+	{
+		size_t offset = m_Strings.size();
+		m_Strings.append(pszValue);
+		m_Strings.push_back('\0');
+		return offset;
+	}
+
+public:
+	std::vector<Action> m_Actions;
+
+private:
+	std::string m_Strings;
+};
+
+class OutputActionListHandler : public IHandleTypeDispatch
+{
+public:
+	void OnHandleDestroy(HandleType_t type, void *object)
+	{
+		delete (OutputActionList *)object;
+	}
+};
+
+HandleType_t g_OutputActionListType = 0;
+OutputActionListHandler g_OutputActionListHandler;
+
+OutputActionList::Action *ReadActionListEntry(IPluginContext *pContext, const cell_t *params, OutputActionList **ppList = nullptr)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	OutputActionList *pList;
+	HandleError err = handlesys->ReadHandle(hndl, g_OutputActionListType, &sec, (void **)&pList);
+	if (err != HandleError_None)
+	{
+		pContext->ThrowNativeError("Invalid OutputActionList handle %x (error %d)", hndl, err);
+		return nullptr;
+	}
+
+	if (params[2] < 0 || (size_t)params[2] >= pList->m_Actions.size())
+	{
+		pContext->ThrowNativeError("Invalid index %d (count: %d)", params[2], (int)pList->m_Actions.size());
+		return nullptr;
+	}
+
+	if (ppList)
+		*ppList = pList;
+
+	return &pList->m_Actions[params[2]];
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputActions(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+
+	if (pEntityOutput == NULL)
+		return BAD_HANDLE;
+
+	OutputActionList *pList = new OutputActionList(pEntityOutput);
+
+	HandleError err;
+	Handle_t hndl = handlesys->CreateHandle(g_OutputActionListType, pList, pContext->GetIdentity(), myself->GetIdentity(), &err);
+	if (hndl == BAD_HANDLE)
+	{
+		delete pList;
+		return pContext->ThrowNativeError("Unable to create OutputActionList handle (error %d)", err);
+	}
+
+	return hndl;
+}
+
+cell_t OutputActionList_Length_get(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	OutputActionList *pList;
+	HandleError err = handlesys->ReadHandle(hndl, g_OutputActionListType, &sec, (void **)&pList);
+	if (err != HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid OutputActionList handle %x (error %d)", hndl, err);
+	}
+
+	return pList->m_Actions.size();
+}
+
+cell_t OutputActionList_GetTarget(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionList *pList;
+	OutputActionList::Action *pAction = ReadActionListEntry(pContext, params, &pList);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[3], params[4], pList->GetString(pAction->target));
+	return 1;
+}
+
+cell_t OutputActionList_GetTargetInput(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionList *pList;
+	OutputActionList::Action *pAction = ReadActionListEntry(pContext, params, &pList);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[3], params[4], pList->GetString(pAction->targetinput));
+	return 1;
+}
+
+cell_t OutputActionList_GetParameter(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionList *pList;
+	OutputActionList::Action *pAction = ReadActionListEntry(pContext, params, &pList);
+	if (!pAction)
+		return 0;
+
+	pContext->StringToLocal(params[3], params[4], pList->GetString(pAction->parameter));
+	return 1;
+}
+
+cell_t OutputActionList_GetDelay(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionList::Action *pAction = ReadActionListEntry(pContext, params);
+	if (!pAction)
+		return sp_ftoc(-1.0f);
+
+	return sp_ftoc(pAction->delay);
+}
+
+cell_t OutputActionList_GetTimesToFire(IPluginContext *pContext, const cell_t *params)
+{
+	OutputActionList::Action *pAction = ReadActionListEntry(pContext, params);
+	if (!pAction)
+		return 0;
+
+	return pAction->timestofire;
+}
+
+/**
+ * Search criteria shared by FindOutputAction and FindOutputActions.
+ * Query strings are never added to the game's pool. One we interned before
+ * compares against the action's pooled strings by pointer; otherwise, and
+ * for strings that did not come from the pool, strcmp decides.
+ */
+class OutputActionFilter
+{
+public:
+	OutputActionFilter(IPluginContext *pContext, cell_t target, cell_t targetinput, cell_t parameter, cell_t delay, cell_t timestofire)
+	{
+		pContext->LocalToString(target, &m_pszTarget);
+		pContext->LocalToString(targetinput, &m_pszTargetInput);
+		pContext->LocalToString(parameter, &m_pszParameter);
+
+		m_iTarget = FindPooled(m_pszTarget);
+		m_iTargetInput = FindPooled(m_pszTargetInput);
+		m_iParameter = FindPooled(m_pszParameter);
+
+		m_flDelay = sp_ctof(delay);
+		m_nTimesToFire = timestofire;
+	}
+
+	bool Matches(CEventAction *pAction) const
+	{
+		if (m_pszTarget[0] && !MatchString(pAction->m_iTarget, m_iTarget, m_pszTarget))
+			return false;
+
+		if (m_pszTargetInput[0] && !MatchString(pAction->m_iTargetInput, m_iTargetInput, m_pszTargetInput))
+			return false;
+
+		if (m_pszParameter[0] && !MatchString(pAction->m_iParameter, m_iParameter, m_pszParameter))
+			return false;
+
+		if (m_flDelay != -1.0f && pAction->m_flDelay != m_flDelay)
+			return false;
+
+		if (m_nTimesToFire != 0 && pAction->m_nTimesToFire != m_nTimesToFire)
+			return false;
+
+		return true;
+	}
+
+private:
+	static string_t FindPooled(const char *pszQuery)
+	{
+		string_t result;
+		if (!pszQuery[0] || !g_StringPool.Find(pszQuery, &result))
+			return NULL_STRING;
+
+		return result;
+	}
+
+	static inline bool MatchString(string_t value, string_t query, const char *pszQuery)
+	{
+		if (query != NULL_STRING && value == query)
+			return true;
+
+		return strcmp(value.ToCStr(), pszQuery) == 0;
+	}
+
+private:
+	char *m_pszTarget;
+	char *m_pszTargetInput;
+	char *m_pszParameter;
+	string_t m_iTarget;
+	string_t m_iTargetInput;
+	string_t m_iParameter;
+	float m_flDelay;
+	int m_nTimesToFire;
+};
+
+template <OutputParamReader Read>
+cell_t FindOutputAction(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+
+	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+		return -1;
+
+	OutputActionFilter filter(pContext, params[4], params[5], params[6], params[7], params[8]);
+
+	int index = 0;
+	for (CEventAction *pAction = pEntityOutput->m_ActionList; pAction != NULL; pAction = pAction->m_pNext, index++)
+	{
+		if (index >= params[3] && filter.Matches(pAction))
+			return index;
+	}
+
+	return -1;
+}
+
+template <OutputParamReader Read>
+cell_t FindOutputActions(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+
+	if (pEntityOutput == NULL || pEntityOutput->m_ActionList == NULL)
+		return 0;
+
+	cell_t *pMatches;
+	pContext->LocalToPhysAddr(params[3], &pMatches);
+
+	OutputActionFilter filter(pContext, params[6], params[7], params[8], params[9], params[10]);
+
+	int found = 0;
+	int index = 0;
+	for (CEventAction *pAction = pEntityOutput->m_ActionList; pAction != NULL && found < params[4]; pAction = pAction->m_pNext, index++)
+	{
+		if (index >= params[5] && filter.Matches(pAction))
+			pMatches[found++] = index;
+	}
+
+	return found;
+}
+
+template <OutputParamReader Read>
+cell_t ClearOutput(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
 
-			pPrev = pAction;
-			pAction = pAction->m_pNext;
+	if (pEntityOutput == NULL)
+		return 0;
+
+	return FreeOutputActions(pEntityOutput);
+}
+
+cell_t ClearEntityOutputs(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
+	if (!pEntity)
+	{
+		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+	}
+
+	return FreeEntityOutputActions(pEntity);
+}
+
+cell_t ClearOutputsByClassname(IPluginContext *pContext, const cell_t *params)
+{
+	char *pClassname, *pOutput;
+	pContext->LocalToString(params[1], &pClassname);
+	pContext->LocalToString(params[2], &pOutput);
+
+	int count = 0;
+	for (CBaseEntity *pEntity = NextEntity(nullptr); pEntity != nullptr; pEntity = NextEntity(pEntity))
+	{
+		const char *pszClassname = gamehelpers->GetEntityClassname(pEntity);
+		if (!pszClassname || strcmp(pszClassname, pClassname) != 0)
+			continue;
+
+		if (pOutput[0] == '\0')
+		{
+			count += FreeEntityOutputActions(pEntity);
+			continue;
 		}
 
-		pPrev->m_pNext = pNewAction;
-		pNewAction->m_pNext = pAction;
+		CBaseEntityOutput *pEntityOutput = GetOutput(pEntity, pOutput);
+		if (pEntityOutput != NULL)
+			count += FreeOutputActions(pEntityOutput);
+	}
+
+	return count;
+}
+
+cell_t GetEntityOutputCount(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
+	if (!pEntity)
+	{
+		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+	}
+
+	const std::vector<OutputField> *pFields = GetOutputFields(pEntity);
+	if (!pFields)
+		return 0;
+
+	return pFields->size();
+}
+
+cell_t GetEntityOutputName(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
+	if (!pEntity)
+	{
+		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
 	}
 
+	const std::vector<OutputField> *pFields = GetOutputFields(pEntity);
+	if (!pFields || params[2] < 0 || (size_t)params[2] >= pFields->size())
+		return 0;
+
+	const OutputField &field = (*pFields)[params[2]];
+	pContext->StringToLocal(params[3], params[4], params[5] ? field.externalName : field.name);
+
 	return 1;
-#else
-	return pContext->ThrowNativeError( "This feature is unsupported on this version of the engine." );
-#endif
+}
+
+cell_t GetOutputOffsetCacheStats(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t *pHits, *pMisses, *pNegative;
+	pContext->LocalToPhysAddr(params[1], &pHits);
+	pContext->LocalToPhysAddr(params[2], &pMisses);
+	pContext->LocalToPhysAddr(params[3], &pNegative);
+
+	*pHits = g_OutputFieldCache.m_Hits;
+	*pMisses = g_OutputFieldCache.m_Misses;
+	*pNegative = g_OutputFieldCache.m_NegativeHits;
+
+	return g_OutputFieldCache.Size();
 }
 
 const sp_nativeinfo_t MyNatives[] =
 {
-	{ "GetOutputActionCount",		GetOutputActionCount },
-	{ "GetOutputActionTarget",		GetOutputActionTarget },
-	{ "SetOutputActionTarget",		SetOutputActionTarget },
-	{ "GetOutputActionTargetInput",	GetOutputActionTargetInput },
-	{ "SetOutputActionTargetInput",	SetOutputActionTargetInput },
-	{ "GetOutputActionParameter",	GetOutputActionParameter },
-	{ "SetOutputActionParameter",	SetOutputActionParameter },
-	{ "GetOutputActionDelay",		GetOutputActionDelay },
-	{ "SetOutputActionDelay",		SetOutputActionDelay },
-	{ "GetOutputActionTimesToFire",	GetOutputActionTimesToFire },
-	{ "SetOutputActionTimesToFire",	SetOutputActionTimesToFire },
-	{ "InsertOutputAction",			InsertOutputAction },
-	{ "RemoveOutputAction",			RemoveOutputAction },
+	{ "GetOutputActionCount",		GetOutputActionCount<ReadOutputByName> },
+	{ "GetOutputActionTarget",		GetOutputActionTarget<ReadOutputByName> },
+	{ "SetOutputActionTarget",		SetOutputActionTarget<ReadOutputByName> },
+	{ "GetOutputActionTargetInput",	GetOutputActionTargetInput<ReadOutputByName> },
+	{ "SetOutputActionTargetInput",	SetOutputActionTargetInput<ReadOutputByName> },
+	{ "GetOutputActionParameter",	GetOutputActionParameter<ReadOutputByName> },
+	{ "SetOutputActionParameter",	SetOutputActionParameter<ReadOutputByName> },
+	{ "GetOutputActionTargetId",		GetOutputActionTargetId<ReadOutputByName> },
+	{ "GetOutputActionTargetInputId",	GetOutputActionTargetInputId<ReadOutputByName> },
+	{ "GetOutputActionParameterId",		GetOutputActionParameterId<ReadOutputByName> },
+	{ "InternOutputString",				InternOutputString },
+	{ "GetOutputActionDelay",		GetOutputActionDelay<ReadOutputByName> },
+	{ "SetOutputActionDelay",		SetOutputActionDelay<ReadOutputByName> },
+	{ "GetOutputActionTimesToFire",	GetOutputActionTimesToFire<ReadOutputByName> },
+	{ "SetOutputActionTimesToFire",	SetOutputActionTimesToFire<ReadOutputByName> },
+	{ "InsertOutputAction",			InsertOutputAction<ReadOutputByName> },
+	{ "RemoveOutputAction",			RemoveOutputAction<ReadOutputByName> },
+	{ "GetOutputOffsetCacheStats",	GetOutputOffsetCacheStats },
+	{ "ClearOutput",				ClearOutput<ReadOutputByName> },
+	{ "ClearEntityOutputs",			ClearEntityOutputs },
+	{ "ClearOutputsByClassname",	ClearOutputsByClassname },
+	{ "GetEntityOutputCount",		GetEntityOutputCount },
+	{ "GetEntityOutputName",		GetEntityOutputName },
+	{ "GetOutputActions",			GetOutputActions<ReadOutputByName> },
+	{ "FindOutputAction",			FindOutputAction<ReadOutputByName> },
+	{ "FindOutputActions",			FindOutputActions<ReadOutputByName> },
+	{ "OutputActionList.Length.get",		OutputActionList_Length_get },
+	{ "OutputActionList.GetTarget",			OutputActionList_GetTarget },
+	{ "OutputActionList.GetTargetInput",	OutputActionList_GetTargetInput },
+	{ "OutputActionList.GetParameter",		OutputActionList_GetParameter },
+	{ "OutputActionList.GetDelay",			OutputActionList_GetDelay },
+	{ "OutputActionList.GetTimesToFire",	OutputActionList_GetTimesToFire },
+	{ "OutputKey.GetActionCount",			GetOutputActionCount<ReadOutputByKey> },
+	{ "OutputKey.GetTarget",				GetOutputActionTarget<ReadOutputByKey> },
+	{ "OutputKey.SetTarget",				SetOutputActionTarget<ReadOutputByKey> },
+	{ "OutputKey.GetTargetInput",			GetOutputActionTargetInput<ReadOutputByKey> },
+	{ "OutputKey.SetTargetInput",			SetOutputActionTargetInput<ReadOutputByKey> },
+	{ "OutputKey.GetParameter",				GetOutputActionParameter<ReadOutputByKey> },
+	{ "OutputKey.SetParameter",				SetOutputActionParameter<ReadOutputByKey> },
+	{ "OutputKey.GetTargetId",				GetOutputActionTargetId<ReadOutputByKey> },
+	{ "OutputKey.GetTargetInputId",			GetOutputActionTargetInputId<ReadOutputByKey> },
+	{ "OutputKey.GetParameterId",			GetOutputActionParameterId<ReadOutputByKey> },
+	{ "OutputKey.GetDelay",					GetOutputActionDelay<ReadOutputByKey> },
+	{ "OutputKey.SetDelay",					SetOutputActionDelay<ReadOutputByKey> },
+	{ "OutputKey.GetTimesToFire",			GetOutputActionTimesToFire<ReadOutputByKey> },
+	{ "OutputKey.SetTimesToFire",			SetOutputActionTimesToFire<ReadOutputByKey> },
+	{ "OutputKey.InsertAction",				InsertOutputAction<ReadOutputByKey> },
+	{ "OutputKey.RemoveAction",				RemoveOutputAction<ReadOutputByKey> },
+	{ "OutputKey.Clear",					ClearOutput<ReadOutputByKey> },
+	{ "OutputKey.GetActions",				GetOutputActions<ReadOutputByKey> },
+	{ "OutputKey.FindAction",				FindOutputAction<ReadOutputByKey> },
+	{ "OutputKey.FindActions",				FindOutputActions<ReadOutputByKey> },
 	{ NULL, NULL },
 };
 
 bool Outputinfo::SDK_OnLoad(char *error, size_t maxlength, bool late)
 {
-#if SOURCE_ENGINE == SE_CSGO
-	IGameConfig *pGameConf;
-
-	if(!gameconfs->LoadGameConfigFile("outputinfo.games", &pGameConf, error, maxlength))
+	HandleError err;
+	g_OutputActionListType = handlesys->CreateType("OutputActionList", &g_OutputActionListHandler, 0, NULL, NULL, myself->GetIdentity(), &err);
+	if (g_OutputActionListType == 0)
 	{
+		snprintf(error, maxlength, "Failed to create OutputActionList handle type (error %d)", err);
 		return false;
 	}
 
-#ifdef PLATFORM_WINDOWS
-	pGameConf->GetAddress("g_EntityListPool", reinterpret_cast<void**>(&g_pEntityListPool));
-	if(g_pEntityListPool == nullptr)
+	if (!g_BatchEdits.Init(error, maxlength) || !g_ActionIterators.Init(error, maxlength) || !g_OutputKeys.Init(error, maxlength))
 	{
-		snprintf(error, maxlength, "Failed to obtain g_pEntityListPool from gamedata");
-		gameconfs->CloseGameConfigFile(pGameConf);
 		return false;
 	}
-#else
-	char *operator_new_reloffset = nullptr;
-	pGameConf->GetMemSig("rel_CEventAction_operator_new", reinterpret_cast<void**>(&operator_new_reloffset));
-	if (operator_new_reloffset == nullptr) {
-		snprintf( error, maxlength, "Failed to obtain rel_CEventAction_operator_new from gamedata" );
-		gameconfs->CloseGameConfigFile(pGameConf);
-		return false;
-	}
-	operator_new_reloffset += 1;
-	g_pEntityListPool = *(CUtlMemoryPool**)((intptr_t)(operator_new_reloffset + 4) + *(intptr_t*)operator_new_reloffset + 12);
-#endif
 
-#ifdef PLATFORM_WINDOWS
-	pGameConf->GetMemSig("g_EntityListPool.Alloc", reinterpret_cast<void**>(&g_EntityListPool_Alloc));
-	if(g_EntityListPool_Alloc == nullptr)
+	sharesys->AddDependency(myself, "sdkhooks.ext", false, true);
+
+	IGameConfig *pGameConf;
+
+	if(!gameconfs->LoadGameConfigFile("outputinfo.games", &pGameConf, error, maxlength))
 	{
-		snprintf( error, maxlength, "Failed to obtain g_EntityListPool.Alloc from gamedata" );
-		gameconfs->CloseGameConfigFile(pGameConf);
 		return false;
 	}
-#else
-	pGameConf->GetMemSig( "CUtlMemoryPool_Alloc", reinterpret_cast<void**>( &g_EntityListPool_Alloc ) );
-	if( g_EntityListPool_Alloc == nullptr )
+
+	g_StringPool.Init(pGameConf);
+	g_OutputEventQueue.Init(pGameConf);
+
+	if (!g_ActionAllocator.Init(pGameConf, error, maxlength))
 	{
-		snprintf( error, maxlength, "Failed to obtain CUtlMemoryPool_Alloc from gamedata" );
-		gameconfs->CloseGameConfigFile( pGameConf );
+		gameconfs->CloseGameConfigFile(pGameConf);
 		return false;
 	}
-#endif
 
 	gameconfs->CloseGameConfigFile(pGameConf);
-#endif
+
+	g_FireHooks.Init();
+	g_LumpGraph.Init(late);
+
+	sharesys->AddInterface(myself, &g_OutputInfoApi);
 
 	return true;
 }
@@ -742,6 +1395,287 @@ bool Outputinfo::SDK_OnLoad(char *error, size_t maxlength, bool late)
 void Outputinfo::SDK_OnAllLoaded()
 {
 	sharesys->AddNatives(myself, MyNatives);
+	sharesys->AddNatives(myself, g_BatchEditNatives);
+	sharesys->AddNatives(myself, g_ActionRefNatives);
+	sharesys->AddNatives(myself, g_ActionIteratorNatives);
+	sharesys->AddNatives(myself, g_TargetIndexNatives);
+	sharesys->AddNatives(myself, g_FireHookNatives);
+	sharesys->AddNatives(myself, g_ProfilerNatives);
+	sharesys->AddNatives(myself, g_ActionPoolNatives);
+	sharesys->AddNatives(myself, g_SnapshotNatives);
+	sharesys->AddNatives(myself, g_EditQueueNatives);
+	sharesys->AddNatives(myself, g_LumpGraphNatives);
+	sharesys->AddNatives(myself, g_OutputGraphNatives);
+	sharesys->AddNatives(myself, g_OutputKeyNatives);
+	sharesys->AddNatives(myself, g_EventQueueNatives);
+	sharesys->AddNatives(myself, g_ThrottleNatives);
+	g_OutputRules.Init();
+	g_OutputGraph.Init();
+	g_OutputThrottle.Init();
+	g_EditQueue.Init();
+	rootconsole->AddRootConsoleCommand3("outputinfo", "OutputInfo extension", this);
+}
+
+void Outputinfo::SDK_OnUnload()
+{
+	handlesys->RemoveType(g_OutputActionListType, myself->GetIdentity());
+	g_BatchEdits.Shutdown();
+	g_ActionIterators.Shutdown();
+	g_OutputKeys.Shutdown();
+	g_OutputThrottle.Shutdown();
+	g_FireHooks.Shutdown();
+	g_OutputGraph.Shutdown();
+	g_OutputRules.Shutdown();
+	g_EditQueue.Shutdown();
+	g_LumpGraph.Shutdown();
+	rootconsole->RemoveRootConsoleCommand("outputinfo", this);
+}
+
+void Outputinfo::OnCoreMapStart(edict_t *pEdictList, int edictCount, int clientMax)
+{
+	g_StringPool.OnLevelStart();
+	g_OutputRules.OnLevelStart();
+	g_TargetIndex.Rebuild();
+	g_OutputSnapshot.Capture();
+}
+
+void Outputinfo::OnCoreMapEnd()
+{
+	g_OutputFieldCache.Clear();
+	g_StringPool.OnLevelEnd();
+	g_ActionRefs.Clear();
+	g_OutputListVersions.clear();
+	g_TargetIndex.Clear();
+	g_OutputThrottle.Clear();
+	g_FireHooks.OnLevelEnd();
+	g_OutputSnapshot.Clear();
+	g_OutputRules.OnLevelEnd();
+	g_EditQueue.Clear();
+	g_OutputGraph.Clear();
+	g_OutputEventQueue.Clear();
+}
+
+bool Outputinfo::QueryInterfaceDrop(SMInterface *pInterface)
+{
+	// Rules keep working for map entities without SDKHooks
+	return pInterface == g_pSDKHooks || SDKExtension::QueryInterfaceDrop(pInterface);
+}
+
+void Outputinfo::NotifyInterfaceDrop(SMInterface *pInterface)
+{
+	if (g_pSDKHooks && pInterface == g_pSDKHooks)
+	{
+		g_pSDKHooks->RemoveEntityListener(&g_OutputRules);
+		g_pSDKHooks->RemoveEntityListener(&g_OutputGraph);
+		g_pSDKHooks = nullptr;
+	}
+}
+
+void Outputinfo::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command)
+{
+	const char *pSubCmd = command->ArgC() >= 3 ? command->Arg(2) : "";
+
+	if (strcmp(pSubCmd, "cache") == 0)
+	{
+		rootconsole->ConsolePrint("[OutputInfo] Output offset cache:");
+		rootconsole->ConsolePrint("  Entries:       %u", (unsigned int)g_OutputFieldCache.Size());
+		rootconsole->ConsolePrint("  Hits:          %u", g_OutputFieldCache.m_Hits);
+		rootconsole->ConsolePrint("  Negative hits: %u", g_OutputFieldCache.m_NegativeHits);
+		rootconsole->ConsolePrint("  Misses:        %u", g_OutputFieldCache.m_Misses);
+		rootconsole->ConsolePrint("[OutputInfo] String pool cache:");
+		rootconsole->ConsolePrint("  Entries:       %u", (unsigned int)g_StringPool.Size());
+		rootconsole->ConsolePrint("  Hits:          %u", g_StringPool.m_Hits);
+		rootconsole->ConsolePrint("  Engine allocs: %u", g_StringPool.m_EngineAllocs);
+		return;
+	}
+
+	if (strcmp(pSubCmd, "targets") == 0)
+	{
+		rootconsole->ConsolePrint("[OutputInfo] Target index entries: %u", (unsigned int)g_TargetIndex.Size());
+		return;
+	}
+
+	if (strcmp(pSubCmd, "rules") == 0)
+	{
+		if (command->ArgC() >= 4 && strcmp(command->Arg(3), "reload") == 0)
+		{
+			g_OutputRules.Reload();
+			rootconsole->ConsolePrint("[OutputInfo] Output rules reloaded, they apply to entities spawned from now on.");
+		}
+
+		rootconsole->ConsolePrint("[OutputInfo] Output rules:");
+		rootconsole->ConsolePrint("  Cached files:  %u", (unsigned int)g_OutputRules.NumFiles());
+		rootconsole->ConsolePrint("  Active rules:  %u", (unsigned int)g_OutputRules.NumRules());
+		rootconsole->ConsolePrint("  Applied ops:   %u", g_OutputRules.m_Applied);
+		return;
+	}
+
+	if (strcmp(pSubCmd, "graph") == 0)
+	{
+		if (!g_LumpGraph.IsReady())
+		{
+			rootconsole->ConsolePrint("[OutputInfo] The entity lump output graph is not ready.");
+			return;
+		}
+
+		rootconsole->ConsolePrint("[OutputInfo] Entity lump output graph: %u nodes, %u edges, %u resolved targets",
+			(unsigned int)g_LumpGraph.m_Nodes.size(), (unsigned int)g_LumpGraph.m_Edges.size(), (unsigned int)g_LumpGraph.m_EdgeTargets.size());
+		return;
+	}
+
+	if (strcmp(pSubCmd, "loops") == 0)
+	{
+		int loops = g_OutputGraph.FindLoops();
+		rootconsole->ConsolePrint("[OutputInfo] %d output loops (%u entities, %u actions in the graph):",
+			loops, (unsigned int)g_OutputGraph.NumNodes(), (unsigned int)g_OutputGraph.NumEdges());
+
+		for (int i = 0; i < loops; i++)
+		{
+			const OutputGraph::Loop &loop = g_OutputGraph.m_Loops[i];
+			rootconsole->ConsolePrint("  #%d: %d steps, %.2fs once around%s", i, loop.numSteps, loop.delay,
+				loop.zeroDelay ? ", ZERO DELAY" : "");
+
+			for (int j = 0; j < loop.numSteps; j++)
+			{
+				const OutputGraph::LoopStep &step = g_OutputGraph.m_LoopSteps[loop.firstStep + j];
+				CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(step.entref);
+				if (!pEntity || step.pAction->m_iIDStamp != step.stamp)
+					continue;
+
+				const char *pszName = GetOutputName(pEntity, step.pOutput);
+				rootconsole->ConsolePrint("    %s (%d) %s -> %s.%s (%.2fs)", gamehelpers->GetEntityClassname(pEntity),
+					gamehelpers->ReferenceToIndex(step.entref), pszName ? pszName : "?",
+					step.pAction->m_iTarget.ToCStr(), step.pAction->m_iTargetInput.ToCStr(), step.pAction->m_flDelay);
+			}
+		}
+		return;
+	}
+
+	if (strcmp(pSubCmd, "events") == 0)
+	{
+		if (!g_OutputEventQueue.IsAvailable())
+		{
+			rootconsole->ConsolePrint("[OutputInfo] The event queue is unavailable, g_EventQueue is missing from gamedata.");
+			return;
+		}
+
+		int count = g_OutputEventQueue.Capture();
+		rootconsole->ConsolePrint("[OutputInfo] %d pending events:", count);
+
+		for (int i = 0; i < count; i++)
+		{
+			const OutputEventQueue::Event &event = g_OutputEventQueue.m_Events[i];
+			rootconsole->ConsolePrint("  %+.2fs %s.%s (caller %d)", event.fireTime - gpGlobals->curtime,
+				event.entTarget != -1 ? "<entity>" : event.target.ToCStr(), event.targetInput.ToCStr(),
+				event.caller != -1 ? gamehelpers->ReferenceToIndex(event.caller) : -1);
+		}
+
+		g_OutputEventQueue.Clear();
+		return;
+	}
+
+	if (strcmp(pSubCmd, "snapshot") == 0)
+	{
+		rootconsole->ConsolePrint("[OutputInfo] Output snapshot: %u outputs, %u actions",
+			(unsigned int)g_OutputSnapshot.NumOutputs(), (unsigned int)g_OutputSnapshot.NumActions());
+		return;
+	}
+
+	if (strcmp(pSubCmd, "pool") == 0)
+	{
+		if (command->ArgC() >= 4)
+		{
+			int free = g_ActionAllocator.Reserve(atoi(command->Arg(3)));
+			rootconsole->ConsolePrint("[OutputInfo] %d action blocks free after reserving.", free);
+		}
+
+		ActionPoolStats stats;
+		g_ActionAllocator.GetStats(stats);
+
+		rootconsole->ConsolePrint("[OutputInfo] CEventAction %s:", g_ActionAllocator.UsesGamePool() ? "pool" : "free list (game pool not resolved, counts are approximate)");
+		rootconsole->ConsolePrint("  Block size:    %d", stats.blockSize);
+		rootconsole->ConsolePrint("  In use:        %d", stats.count);
+		rootconsole->ConsolePrint("  Peak:          %d", stats.peak);
+		rootconsole->ConsolePrint("  Free:          %d", stats.free);
+		rootconsole->ConsolePrint("  Blobs:         %d", stats.blobs);
+		return;
+	}
+
+	if (strcmp(pSubCmd, "hooks") == 0)
+	{
+		if (!g_FireHooks.IsAvailable())
+		{
+			rootconsole->ConsolePrint("[OutputInfo] FireOutput hooks are unavailable.");
+			return;
+		}
+
+		rootconsole->ConsolePrint("[OutputInfo] FireOutput hooks:");
+		rootconsole->ConsolePrint("  Subscriptions:  %u", (unsigned int)g_FireHooks.Size());
+		rootconsole->ConsolePrint("  Cached outputs: %u", (unsigned int)g_FireHooks.CachedOutputs());
+
+		unsigned int suppressed = 0;
+		for (size_t i = 0; i < g_OutputThrottle.m_Entries.size(); i++)
+			suppressed += g_OutputThrottle.m_Entries[i].suppressed;
+
+		rootconsole->ConsolePrint("  Throttled:      %u outputs, %u fires suppressed", (unsigned int)g_OutputThrottle.Size(), suppressed);
+		return;
+	}
+
+	if (strcmp(pSubCmd, "profile") == 0)
+	{
+		const char *pAction = command->ArgC() >= 4 ? command->Arg(3) : "";
+
+		if (strcmp(pAction, "start") == 0 || strcmp(pAction, "stop") == 0)
+		{
+			if (!g_OutputProfiler.SetEnabled(strcmp(pAction, "start") == 0))
+				rootconsole->ConsolePrint("[OutputInfo] FireOutput hooks are unavailable.");
+			else
+				rootconsole->ConsolePrint("[OutputInfo] Output profiler %s.", g_OutputProfiler.IsEnabled() ? "started" : "stopped");
+			return;
+		}
+
+		if (strcmp(pAction, "reset") == 0)
+		{
+			g_OutputProfiler.Reset();
+			rootconsole->ConsolePrint("[OutputInfo] Output profile reset.");
+			return;
+		}
+
+		int count = atoi(pAction);
+		g_OutputProfiler.Print(count > 0 ? count : 20);
+		return;
+	}
+
+	if (strcmp(pSubCmd, "bench") == 0)
+	{
+		int count = command->ArgC() >= 4 ? atoi(command->Arg(3)) : 0;
+		int samples = command->ArgC() >= 5 ? atoi(command->Arg(4)) : 1000;
+		if (samples <= 0)
+			samples = 1000;
+
+		if (count > 0)
+		{
+			RunOutputBenchmark(count, samples);
+			return;
+		}
+
+		for (int n = 1; n <= 10000; n *= 10)
+			RunOutputBenchmark(n, samples);
+		return;
+	}
+
+	rootconsole->ConsolePrint("OutputInfo Menu:");
+	rootconsole->DrawGenericOption("cache", "Show output offset and string pool cache statistics");
+	rootconsole->DrawGenericOption("targets", "Show the size of the reverse target index");
+	rootconsole->DrawGenericOption("rules", "Show output rules: rules [reload]");
+	rootconsole->DrawGenericOption("graph", "Show the size of the entity lump output graph");
+	rootconsole->DrawGenericOption("loops", "List output loops between entities, flagging zero delay ones");
+	rootconsole->DrawGenericOption("events", "List the game's pending I/O events");
+	rootconsole->DrawGenericOption("snapshot", "Show the size of the map start output snapshot");
+	rootconsole->DrawGenericOption("pool", "Show CEventAction pool statistics: pool [reserve count]");
+	rootconsole->DrawGenericOption("hooks", "Show FireOutput hook subscriptions");
+	rootconsole->DrawGenericOption("profile", "Output fire profiler: profile <start|stop|reset|[top N]>");
+	rootconsole->DrawGenericOption("bench", "Benchmark action list operations: bench [actions] [samples]");
 }
 
 bool Outputinfo::SDK_OnMetamodLoad(ISmmAPI *ismm, char *error, size_t maxlen, bool late)
@@ -44,7 +44,7 @@
  * @brief Sample implementation of the SDK Extension.
  * Note: Uncomment one of the pre-defined virtual functions in order to use it.
  */
-class Outputinfo : public SDKExtension
+class Outputinfo : public SDKExtension, public IRootConsoleCommand
 {
 public:
 	/**
@@ -60,7 +60,7 @@ public:
 	/**
 	 * @brief This is called right before the extension is unloaded.
 	 */
-	//virtual void SDK_OnUnload();
+	virtual void SDK_OnUnload();
 
 	/**
 	 * @brief This is called once all known extensions have been loaded.
@@ -81,6 +81,28 @@ public:
 	 * @return			True if working, false otherwise.
 	 */
 	//virtual bool QueryRunning(char *error, size_t maxlength);
+
+	/**
+	 * @brief Asks whether an interface we use may be unloaded.
+	 */
+	virtual bool QueryInterfaceDrop(SMInterface *pInterface);
+
+	/**
+	 * @brief Notifies us that an interface we use is being unloaded.
+	 */
+	virtual void NotifyInterfaceDrop(SMInterface *pInterface);
+
+	/**
+	 * @brief Called once all map entities have spawned.
+	 */
+	virtual void OnCoreMapStart(edict_t *pEdictList, int edictCount, int clientMax);
+
+	/**
+	 * @brief Called on level shutdown; flushes per-map caches.
+	 */
+	virtual void OnCoreMapEnd();
+public: // IRootConsoleCommand
+	virtual void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command);
 public:
 #if defined SMEXT_CONF_METAMOD
 	/**
@@ -116,4 +138,6 @@ public:
 #endif
 };
 
+extern const sp_nativeinfo_t MyNatives[];
+
 #endif // _INCLUDE_SOURCEMOD_EXTENSION_PROPER_H_
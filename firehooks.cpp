@@ -0,0 +1,424 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "firehooks.h"
+#include "entityoutput.h"
+#include "profiler.h"
+#include "throttle.h"
+#include <CDetour/detours.h>
+#include <IForwardSys.h>
+
+/**
+ * @file firehooks.cpp
+ * @brief Filtered FireOutput hooks for plugins.
+ */
+
+OutputFireHooks g_FireHooks;
+
+// variant_t is passed by value; the leading ints soak up its members
+DETOUR_DECL_MEMBER8(FireOutput, void, int, what, int, the, int, hell, int, msvc, void *, variant_t, CBaseEntity *, pActivator, CBaseEntity *, pCaller, float, fDelay)
+{
+	CBaseEntityOutput *pOutput = reinterpret_cast<CBaseEntityOutput *>(this);
+	FireOutputValue value = { { what, the, hell, msvc }, variant_t };
+
+	if (!g_OutputThrottle.OnFireOutput(pOutput, value, pActivator, pCaller, fDelay))
+		return;
+
+	g_FireHooks.FireOutput(pOutput, value, pActivator, pCaller, fDelay);
+}
+
+static void CallFireOutput(CBaseEntityOutput *pOutput, const FireOutputValue &value, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay)
+{
+	FireOutputClass *pThis = reinterpret_cast<FireOutputClass *>(pOutput);
+	(pThis->*FireOutputClass::FireOutput_Actual)(value.words[0], value.words[1], value.words[2], value.words[3], value.pLast, pActivator, pCaller, flDelay);
+}
+
+void OutputFireHooks::FireOutput(CBaseEntityOutput *pOutput, const FireOutputValue &value, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay)
+{
+	if (!OnFireOutput(pOutput, pActivator, pCaller, flDelay))
+		return;
+
+	if (!g_OutputProfiler.IsEnabled())
+	{
+		CallFireOutput(pOutput, value, pActivator, pCaller, flDelay);
+		return;
+	}
+
+	OutputProfiler::Entry *pEntry = g_OutputProfiler.Find(pOutput, pCaller);
+	if (pEntry)
+	{
+		pEntry->fires++;
+		for (CEventAction *pAction = pOutput->m_ActionList; pAction != NULL; pAction = pAction->m_pNext)
+			pEntry->actions++;
+	}
+
+	OutputProfiler::Clock::time_point start = OutputProfiler::Clock::now();
+	CallFireOutput(pOutput, value, pActivator, pCaller, flDelay);
+
+	if (pEntry)
+		pEntry->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(OutputProfiler::Clock::now() - start).count();
+}
+
+OutputFireHooks::OutputFireHooks() :
+	m_pGameConf(nullptr),
+	m_pDetour(nullptr),
+	m_bDirty(false),
+	m_iFiring(0)
+{
+}
+
+void OutputFireHooks::Init()
+{
+	char error[255];
+	if (!gameconfs->LoadGameConfigFile("sdktools.games", &m_pGameConf, error, sizeof(error)))
+	{
+		smutils->LogError(myself, "FireOutput hooks disabled, could not load sdktools.games: %s", error);
+		m_pGameConf = nullptr;
+		return;
+	}
+
+	CDetourManager::Init(smutils->GetScriptingEngine(), m_pGameConf);
+
+	m_pDetour = DETOUR_CREATE_MEMBER(FireOutput, "FireOutput");
+	if (!m_pDetour)
+	{
+		smutils->LogError(myself, "FireOutput hooks disabled, could not create the FireOutput detour");
+		return;
+	}
+
+	m_pDetour->EnableDetour();
+	plsys->AddPluginsListener(this);
+}
+
+void OutputFireHooks::Shutdown()
+{
+	if (m_pDetour)
+	{
+		plsys->RemovePluginsListener(this);
+		m_pDetour->Destroy();
+		m_pDetour = nullptr;
+	}
+
+	if (m_pGameConf)
+	{
+		gameconfs->CloseGameConfigFile(m_pGameConf);
+		m_pGameConf = nullptr;
+	}
+
+	m_Outputs.clear();
+	m_Subs.clear();
+}
+
+bool OutputFireHooks::Subscribe(IPluginContext *pContext, IPluginFunction *pCallback, cell_t entref, const char *pszClassname, const char *pszOutput)
+{
+	for (size_t i = 0; i < m_Subs.size(); i++)
+	{
+		Subscription *pSub = m_Subs[i].get();
+		if (pSub->pCallback == pCallback && pSub->entref == entref
+			&& pSub->classname == pszClassname && pSub->output == pszOutput)
+		{
+			return false;
+		}
+	}
+
+	Subscription *pSub = new Subscription;
+	pSub->pCallback = pCallback;
+	pSub->pRuntime = pContext->GetRuntime();
+	pSub->entref = entref;
+	pSub->classname = pszClassname;
+	pSub->output = pszOutput;
+	m_Subs.emplace_back(pSub);
+
+	m_bDirty = true;
+	Compact();
+	return true;
+}
+
+bool OutputFireHooks::Unsubscribe(IPluginFunction *pCallback, cell_t entref, const char *pszClassname, const char *pszOutput)
+{
+	for (size_t i = 0; i < m_Subs.size(); i++)
+	{
+		Subscription *pSub = m_Subs[i].get();
+		if (pSub->pCallback == pCallback && pSub->entref == entref
+			&& pSub->classname == pszClassname && pSub->output == pszOutput)
+		{
+			Remove(pSub);
+			Compact();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void OutputFireHooks::Remove(Subscription *pSub)
+{
+	// Only marked here; a callback may be running from the cached list
+	pSub->pCallback = nullptr;
+	m_bDirty = true;
+}
+
+void OutputFireHooks::Compact()
+{
+	if (!m_bDirty || m_iFiring > 0)
+		return;
+
+	for (size_t i = 0; i < m_Subs.size(); )
+	{
+		if (m_Subs[i]->pCallback == nullptr)
+		{
+			m_Subs[i] = std::move(m_Subs.back());
+			m_Subs.pop_back();
+			continue;
+		}
+
+		i++;
+	}
+
+	m_Outputs.clear();
+	m_bDirty = false;
+}
+
+OutputFireHooks::FiredOutput *OutputFireHooks::Classify(CBaseEntityOutput *pOutput, CBaseEntity *pCaller)
+{
+	if (!pCaller)
+		return nullptr;
+
+	FiredOutput &fired = m_Outputs[pOutput];
+	fired.entref = gamehelpers->EntityToReference(pCaller);
+	fired.pEntity = pCaller;
+	fired.pszName = nullptr;
+	fired.subs.clear();
+
+	// The caller is the owner of the output for every output the game fires itself
+	int offset = (int)((intptr_t)pOutput - (intptr_t)pCaller);
+	const OutputField *pField = FindOutputFieldByOffset(pCaller, offset);
+	if (!pField)
+		return &fired;
+
+	fired.pszName = pField->name;
+
+	const char *pszClassname = gamehelpers->GetEntityClassname(pCaller);
+	for (size_t i = 0; i < m_Subs.size(); i++)
+	{
+		Subscription *pSub = m_Subs[i].get();
+		if (pSub->pCallback == nullptr)
+			continue;
+
+		if (pSub->output != pField->name && (!pField->externalName || pSub->output != pField->externalName))
+			continue;
+
+		if (pSub->entref != -1)
+		{
+			if (gamehelpers->ReferenceToEntity(pSub->entref) != pCaller)
+				continue;
+		}
+		else if (!pszClassname || pSub->classname != pszClassname)
+		{
+			continue;
+		}
+
+		fired.subs.push_back(pSub);
+	}
+
+	return &fired;
+}
+
+bool OutputFireHooks::OnFireOutput(CBaseEntityOutput *pOutput, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay)
+{
+	if (m_Subs.empty())
+		return true;
+
+	FiredOutput *pFired;
+
+	auto it = m_Outputs.find(pOutput);
+	if (it != m_Outputs.end() && it->second.pEntity == pCaller
+		&& gamehelpers->ReferenceToEntity(it->second.entref) == pCaller)
+	{
+		pFired = &it->second;
+	}
+	else
+	{
+		pFired = Classify(pOutput, pCaller);
+	}
+
+	if (!pFired || pFired->subs.empty())
+		return true;
+
+	return Dispatch(pFired, pActivator, pCaller, flDelay);
+}
+
+bool OutputFireHooks::Dispatch(FiredOutput *pFired, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay)
+{
+	cell_t caller = gamehelpers->EntityToBCompatRef(pCaller);
+	cell_t activator = pActivator ? gamehelpers->EntityToBCompatRef(pActivator) : -1;
+
+	cell_t result = Pl_Continue;
+
+	m_iFiring++;
+	for (size_t i = 0; i < pFired->subs.size(); i++)
+	{
+		Subscription *pSub = pFired->subs[i];
+		if (pSub->pCallback == nullptr)
+			continue;
+
+		cell_t res = Pl_Continue;
+		pSub->pCallback->PushString(pFired->pszName);
+		pSub->pCallback->PushCell(caller);
+		pSub->pCallback->PushCell(activator);
+		pSub->pCallback->PushFloat(flDelay);
+		pSub->pCallback->Execute(&res);
+
+		if (res > result)
+			result = res;
+
+		if (result == Pl_Stop)
+			break;
+	}
+	m_iFiring--;
+
+	Compact();
+
+	return result < Pl_Handled;
+}
+
+void OutputFireHooks::OnLevelEnd()
+{
+	for (size_t i = 0; i < m_Subs.size(); i++)
+	{
+		if (m_Subs[i]->entref != -1)
+			Remove(m_Subs[i].get());
+	}
+
+	m_Outputs.clear();
+	Compact();
+}
+
+void OutputFireHooks::OnPluginUnloaded(IPlugin *plugin)
+{
+	IPluginRuntime *pRuntime = plugin->GetRuntime();
+	for (size_t i = 0; i < m_Subs.size(); i++)
+	{
+		if (m_Subs[i]->pRuntime == pRuntime)
+			Remove(m_Subs[i].get());
+	}
+
+	Compact();
+}
+
+static bool ReadHookParams(IPluginContext *pContext, cell_t funcid, IPluginFunction **ppCallback)
+{
+	if (!g_FireHooks.IsAvailable())
+	{
+		pContext->ThrowNativeError("FireOutput hooks are unavailable, check the error log");
+		return false;
+	}
+
+	*ppCallback = pContext->GetFunctionById(funcid);
+	if (!*ppCallback)
+	{
+		pContext->ThrowNativeError("Invalid function id (%X)", funcid);
+		return false;
+	}
+
+	return true;
+}
+
+cell_t HookOutputFire(IPluginContext *pContext, const cell_t *params)
+{
+	char *pOutput;
+	pContext->LocalToString(params[2], &pOutput);
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
+	if (!pEntity)
+	{
+		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+	}
+
+	IPluginFunction *pCallback;
+	if (!ReadHookParams(pContext, params[3], &pCallback))
+		return 0;
+
+	return g_FireHooks.Subscribe(pContext, pCallback, gamehelpers->EntityToReference(pEntity), "", pOutput);
+}
+
+cell_t HookOutputFireByClassname(IPluginContext *pContext, const cell_t *params)
+{
+	char *pClassname, *pOutput;
+	pContext->LocalToString(params[1], &pClassname);
+	pContext->LocalToString(params[2], &pOutput);
+
+	IPluginFunction *pCallback;
+	if (!ReadHookParams(pContext, params[3], &pCallback))
+		return 0;
+
+	return g_FireHooks.Subscribe(pContext, pCallback, -1, pClassname, pOutput);
+}
+
+cell_t UnhookOutputFire(IPluginContext *pContext, const cell_t *params)
+{
+	char *pOutput;
+	pContext->LocalToString(params[2], &pOutput);
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
+	if (!pEntity)
+	{
+		return pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+	}
+
+	IPluginFunction *pCallback;
+	if (!ReadHookParams(pContext, params[3], &pCallback))
+		return 0;
+
+	return g_FireHooks.Unsubscribe(pCallback, gamehelpers->EntityToReference(pEntity), "", pOutput);
+}
+
+cell_t UnhookOutputFireByClassname(IPluginContext *pContext, const cell_t *params)
+{
+	char *pClassname, *pOutput;
+	pContext->LocalToString(params[1], &pClassname);
+	pContext->LocalToString(params[2], &pOutput);
+
+	IPluginFunction *pCallback;
+	if (!ReadHookParams(pContext, params[3], &pCallback))
+		return 0;
+
+	return g_FireHooks.Unsubscribe(pCallback, -1, pClassname, pOutput);
+}
+
+const sp_nativeinfo_t g_FireHookNatives[] =
+{
+	{ "HookOutputFire",					HookOutputFire },
+	{ "HookOutputFireByClassname",		HookOutputFireByClassname },
+	{ "UnhookOutputFire",				UnhookOutputFire },
+	{ "UnhookOutputFireByClassname",	UnhookOutputFireByClassname },
+	{ NULL, NULL },
+};
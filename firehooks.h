@@ -0,0 +1,139 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_FIREHOOKS_H_
+#define _INCLUDE_OUTPUTINFO_FIREHOOKS_H_
+
+/**
+ * @file firehooks.h
+ * @brief Filtered FireOutput hooks for plugins.
+ */
+
+#include "extension.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CBaseEntityOutput;
+class CDetour;
+
+/**
+ * @brief The variant_t passed by value to FireOutput, as the detour receives it.
+ */
+struct FireOutputValue
+{
+	int words[4];
+	void *pLast;
+};
+
+/**
+ * Plugins subscribe by entity or classname plus output name. Each fired output
+ * is classified once against the subscriptions and cached by its address, so
+ * outputs nobody subscribed to cost one hash lookup and never reach SourcePawn.
+ * The detour stays enabled from Init to Shutdown: SDKTools detours FireOutput
+ * too, and detours toggled out of order restore each other's stale prologues.
+ * With no subscriptions, throttles or profiling, a fire costs three checks.
+ */
+class OutputFireHooks : public IPluginsListener
+{
+public:
+	OutputFireHooks();
+
+	/**
+	 * @brief Creates the FireOutput detour from sdktools gamedata.
+	 * Failure is not fatal; the hook natives will throw instead.
+	 */
+	void Init();
+	void Shutdown();
+
+	bool IsAvailable() { return m_pDetour != nullptr; }
+
+	bool Subscribe(IPluginContext *pContext, IPluginFunction *pCallback, cell_t entref, const char *pszClassname, const char *pszOutput);
+	bool Unsubscribe(IPluginFunction *pCallback, cell_t entref, const char *pszClassname, const char *pszOutput);
+
+	/**
+	 * @brief Called from the detour before the output fires.
+	 *
+	 * @return				False to block the output.
+	 */
+	bool OnFireOutput(CBaseEntityOutput *pOutput, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay);
+
+	/**
+	 * @brief Runs the plugin hooks and profiler, then the game's FireOutput.
+	 * Used by the detour after throttling, and to fire coalesced outputs.
+	 */
+	void FireOutput(CBaseEntityOutput *pOutput, const FireOutputValue &value, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay);
+
+	void OnLevelEnd();
+
+	size_t Size() { return m_Subs.size(); }
+	size_t CachedOutputs() { return m_Outputs.size(); }
+
+public: // IPluginsListener
+	void OnPluginUnloaded(IPlugin *plugin);
+
+private:
+	struct Subscription
+	{
+		IPluginFunction *pCallback;
+		IPluginRuntime *pRuntime;
+		cell_t entref;				/**< Entity to match, or -1 to match by classname */
+		std::string classname;
+		std::string output;
+	};
+
+	struct FiredOutput
+	{
+		cell_t entref;
+		CBaseEntity *pEntity;
+		const char *pszName;
+		std::vector<Subscription *> subs;
+	};
+
+	FiredOutput *Classify(CBaseEntityOutput *pOutput, CBaseEntity *pCaller);
+	bool Dispatch(FiredOutput *pFired, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay);
+	void Remove(Subscription *pSub);
+	void Compact();
+
+private:
+	std::vector<std::unique_ptr<Subscription>> m_Subs;
+	std::unordered_map<CBaseEntityOutput *, FiredOutput> m_Outputs;
+	IGameConfig *m_pGameConf;
+	CDetour *m_pDetour;
+	bool m_bDirty;
+	int m_iFiring;
+};
+
+extern OutputFireHooks g_FireHooks;
+extern const sp_nativeinfo_t g_FireHookNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_FIREHOOKS_H_
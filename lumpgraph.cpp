@@ -0,0 +1,521 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "lumpgraph.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+/**
+ * @file lumpgraph.cpp
+ * @brief Output graph of the map's entity lump, built on a worker thread.
+ */
+
+SH_DECL_HOOK6(IServerGameDLL, LevelInit, SH_NOATTRIB, 0, bool, char const *, char const *, char const *, char const *, bool, bool);
+
+OutputLumpGraph g_LumpGraph;
+
+OutputLumpGraph::OutputLumpGraph() :
+	m_pThread(nullptr),
+	m_bReady(false),
+	m_bHooked(false)
+{
+}
+
+void OutputLumpGraph::Init(bool late)
+{
+	SH_ADD_HOOK(IServerGameDLL, LevelInit, gamedll, SH_MEMBER(this, &OutputLumpGraph::Hook_LevelInit), false);
+	m_bHooked = true;
+
+#if SOURCE_ENGINE >= SE_ORANGEBOX
+	if (late && engine->GetMapEntitiesString())
+		Analyze(engine->GetMapEntitiesString());
+#endif
+}
+
+void OutputLumpGraph::Shutdown()
+{
+	if (m_bHooked)
+	{
+		SH_REMOVE_HOOK(IServerGameDLL, LevelInit, gamedll, SH_MEMBER(this, &OutputLumpGraph::Hook_LevelInit), false);
+		m_bHooked = false;
+	}
+
+	Join();
+}
+
+bool OutputLumpGraph::Hook_LevelInit(char const *pMapName, char const *pMapEntities, char const *pOldLevel, char const *pLandmarkName, bool loadGame, bool background)
+{
+	if (pMapEntities)
+		Analyze(pMapEntities);
+
+	RETURN_META_VALUE(MRES_IGNORED, true);
+}
+
+void OutputLumpGraph::Analyze(const char *pszMapEntities)
+{
+	Join();
+
+	m_bReady = false;
+	m_Nodes.clear();
+	m_Edges.clear();
+	m_EdgeTargets.clear();
+	m_Incoming.clear();
+	m_Strings.clear();
+	m_Lump = pszMapEntities;
+
+	m_pThread = threader->MakeThread(this, Thread_Default);
+	if (!m_pThread)
+		RunThread(nullptr);
+}
+
+void OutputLumpGraph::Join()
+{
+	if (!m_pThread)
+		return;
+
+	m_pThread->WaitForThread();
+	m_pThread->DestroyThis();
+	m_pThread = nullptr;
+}
+
+bool OutputLumpGraph::WaitReady()
+{
+	Join();
+	return m_bReady;
+}
+
+void OutputLumpGraph::RunThread(IThreadHandle *pHandle)
+{
+	Parse();
+	Resolve();
+
+	std::string().swap(m_Lump);
+	m_bReady = true;
+}
+
+void OutputLumpGraph::OnTerminate(IThreadHandle *pHandle, bool cancel)
+{
+}
+
+int OutputLumpGraph::AddString(const char *pszValue, size_t length)
+{
+	int offset = (int)m_Strings.size();
+	m_Strings.insert(m_Strings.end(), pszValue, pszValue + length);
+	m_Strings.push_back('\0');
+	return offset;
+}
+
+static const char *ReadToken(const char *p, const char **ppStart, size_t *pLength)
+{
+	// p is just past the opening quote
+	const char *pEnd = strchr(p, '"');
+	if (!pEnd)
+		return nullptr;
+
+	*ppStart = p;
+	*pLength = pEnd - p;
+	return pEnd + 1;
+}
+
+void OutputLumpGraph::Parse()
+{
+	struct KeyValue
+	{
+		const char *key;
+		size_t keyLength;
+		const char *value;
+		size_t valueLength;
+	};
+
+	std::vector<KeyValue> keyvalues;
+
+	// Offset 0 is the empty string
+	m_Strings.push_back('\0');
+
+	const char *p = m_Lump.c_str();
+	while (*p)
+	{
+		if (*p == '{')
+		{
+			keyvalues.clear();
+			p++;
+			continue;
+		}
+
+		if (*p == '"')
+		{
+			KeyValue kv;
+			p = ReadToken(p + 1, &kv.key, &kv.keyLength);
+			if (!p)
+				break;
+
+			p = strchr(p, '"');
+			if (!p)
+				break;
+
+			p = ReadToken(p + 1, &kv.value, &kv.valueLength);
+			if (!p)
+				break;
+
+			keyvalues.push_back(kv);
+			continue;
+		}
+
+		if (*p != '}')
+		{
+			p++;
+			continue;
+		}
+
+		p++;
+
+		Node node;
+		node.classname = 0;
+		node.targetname = 0;
+		node.hammerid = -1;
+		node.firstEdge = (int)m_Edges.size();
+		node.numEdges = 0;
+		node.firstIncoming = 0;
+		node.numIncoming = 0;
+
+		int nodeIndex = (int)m_Nodes.size();
+		for (size_t i = 0; i < keyvalues.size(); i++)
+		{
+			const KeyValue &kv = keyvalues[i];
+
+			if (kv.keyLength == 9 && strncmp(kv.key, "classname", 9) == 0)
+			{
+				node.classname = AddString(kv.value, kv.valueLength);
+				continue;
+			}
+			if (kv.keyLength == 10 && strncmp(kv.key, "targetname", 10) == 0)
+			{
+				node.targetname = AddString(kv.value, kv.valueLength);
+				continue;
+			}
+			if (kv.keyLength == 8 && strncmp(kv.key, "hammerid", 8) == 0)
+			{
+				node.hammerid = atoi(std::string(kv.value, kv.valueLength).c_str());
+				continue;
+			}
+
+			// Outputs are the only keyvalues with exactly five fields;
+			// newer maps separate them with ESC so parameters may contain commas
+			char separator = memchr(kv.value, '\x1b', kv.valueLength) ? '\x1b' : ',';
+
+			const char *fields[5];
+			size_t lengths[5];
+			int field = 0;
+			fields[0] = kv.value;
+			for (size_t j = 0; j < kv.valueLength; j++)
+			{
+				if (kv.value[j] != separator)
+					continue;
+
+				if (++field > 4)
+					break;
+
+				lengths[field - 1] = &kv.value[j] - fields[field - 1];
+				fields[field] = &kv.value[j + 1];
+			}
+
+			if (field != 4)
+				continue;
+
+			lengths[4] = kv.value + kv.valueLength - fields[4];
+
+			Edge edge;
+			edge.source = nodeIndex;
+			edge.output = AddString(kv.key, kv.keyLength);
+			edge.target = AddString(fields[0], lengths[0]);
+			edge.targetInput = AddString(fields[1], lengths[1]);
+			edge.parameter = AddString(fields[2], lengths[2]);
+			edge.delay = (float)atof(std::string(fields[3], lengths[3]).c_str());
+			edge.timesToFire = lengths[4] ? atoi(std::string(fields[4], lengths[4]).c_str()) : -1;
+			edge.firstTarget = 0;
+			edge.numTargets = 0;
+
+			m_Edges.push_back(edge);
+			node.numEdges++;
+		}
+
+		m_Nodes.push_back(node);
+	}
+}
+
+static std::string LowerCase(const char *pszValue)
+{
+	std::string lower(pszValue);
+	for (size_t i = 0; i < lower.size(); i++)
+		lower[i] = (char)tolower((unsigned char)lower[i]);
+
+	return lower;
+}
+
+void OutputLumpGraph::Resolve()
+{
+	std::unordered_map<std::string, std::vector<int>> byName, byClassname;
+	std::vector<std::string> names(m_Nodes.size());
+
+	for (size_t i = 0; i < m_Nodes.size(); i++)
+	{
+		names[i] = LowerCase(String(m_Nodes[i].targetname));
+		if (!names[i].empty())
+			byName[names[i]].push_back((int)i);
+
+		byClassname[LowerCase(String(m_Nodes[i].classname))].push_back((int)i);
+	}
+
+	// Same lookup order as the game: !self, trailing wildcard, targetname, classname
+	std::vector<int> incomingCount(m_Nodes.size(), 0);
+	for (size_t i = 0; i < m_Edges.size(); i++)
+	{
+		Edge &edge = m_Edges[i];
+		edge.firstTarget = (int)m_EdgeTargets.size();
+
+		std::string target = LowerCase(String(edge.target));
+		if (target == "!self")
+		{
+			m_EdgeTargets.push_back(edge.source);
+		}
+		else if (target.empty() || target[0] == '!')
+		{
+			// !activator, !caller etc. are only known when the output fires
+		}
+		else if (target[target.size() - 1] == '*')
+		{
+			size_t prefix = target.size() - 1;
+			for (size_t j = 0; j < names.size(); j++)
+			{
+				if (!names[j].empty() && names[j].compare(0, prefix, target, 0, prefix) == 0)
+					m_EdgeTargets.push_back((int)j);
+			}
+		}
+		else
+		{
+			const std::vector<int> *pMatches = nullptr;
+
+			auto name = byName.find(target);
+			if (name != byName.end())
+			{
+				pMatches = &name->second;
+			}
+			else
+			{
+				auto classname = byClassname.find(target);
+				if (classname != byClassname.end())
+					pMatches = &classname->second;
+			}
+
+			if (pMatches)
+				m_EdgeTargets.insert(m_EdgeTargets.end(), pMatches->begin(), pMatches->end());
+		}
+
+		edge.numTargets = (int)m_EdgeTargets.size() - edge.firstTarget;
+		for (int j = 0; j < edge.numTargets; j++)
+			incomingCount[m_EdgeTargets[edge.firstTarget + j]]++;
+	}
+
+	int offset = 0;
+	for (size_t i = 0; i < m_Nodes.size(); i++)
+	{
+		m_Nodes[i].firstIncoming = offset;
+		offset += incomingCount[i];
+	}
+
+	m_Incoming.resize(offset);
+	for (size_t i = 0; i < m_Edges.size(); i++)
+	{
+		const Edge &edge = m_Edges[i];
+		for (int j = 0; j < edge.numTargets; j++)
+		{
+			Node &node = m_Nodes[m_EdgeTargets[edge.firstTarget + j]];
+			m_Incoming[node.firstIncoming + node.numIncoming++] = (int)i;
+		}
+	}
+}
+
+static OutputLumpGraph::Node *ReadNode(IPluginContext *pContext, cell_t node)
+{
+	if (!g_LumpGraph.WaitReady())
+	{
+		pContext->ThrowNativeError("The output graph is unavailable, no map was analyzed");
+		return nullptr;
+	}
+
+	if (node < 0 || node >= (cell_t)g_LumpGraph.m_Nodes.size())
+	{
+		pContext->ThrowNativeError("Invalid node %d (count: %d)", node, (int)g_LumpGraph.m_Nodes.size());
+		return nullptr;
+	}
+
+	return &g_LumpGraph.m_Nodes[node];
+}
+
+static OutputLumpGraph::Edge *ReadEdge(IPluginContext *pContext, cell_t node, cell_t edge)
+{
+	OutputLumpGraph::Node *pNode = ReadNode(pContext, node);
+	if (!pNode)
+		return nullptr;
+
+	if (edge < 0 || edge >= pNode->numEdges)
+	{
+		pContext->ThrowNativeError("Invalid edge %d (count: %d)", edge, pNode->numEdges);
+		return nullptr;
+	}
+
+	return &g_LumpGraph.m_Edges[pNode->firstEdge + edge];
+}
+
+cell_t IsOutputGraphReady(IPluginContext *pContext, const cell_t *params)
+{
+	return g_LumpGraph.IsReady();
+}
+
+cell_t GetOutputGraphNodeCount(IPluginContext *pContext, const cell_t *params)
+{
+	if (!g_LumpGraph.WaitReady())
+		return 0;
+
+	return (cell_t)g_LumpGraph.m_Nodes.size();
+}
+
+cell_t FindOutputGraphNode(IPluginContext *pContext, const cell_t *params)
+{
+	if (!g_LumpGraph.WaitReady())
+		return -1;
+
+	char *pName;
+	pContext->LocalToString(params[1], &pName);
+
+	for (size_t i = params[2] < 0 ? 0 : (size_t)params[2] + 1; i < g_LumpGraph.m_Nodes.size(); i++)
+	{
+		if (stricmp(g_LumpGraph.String(g_LumpGraph.m_Nodes[i].targetname), pName) == 0)
+			return (cell_t)i;
+	}
+
+	return -1;
+}
+
+cell_t GetOutputGraphNode(IPluginContext *pContext, const cell_t *params)
+{
+	OutputLumpGraph::Node *pNode = ReadNode(pContext, params[1]);
+	if (!pNode)
+		return -1;
+
+	pContext->StringToLocal(params[2], params[3], g_LumpGraph.String(pNode->classname));
+	pContext->StringToLocal(params[4], params[5], g_LumpGraph.String(pNode->targetname));
+	return pNode->hammerid;
+}
+
+cell_t GetOutputGraphEdgeCount(IPluginContext *pContext, const cell_t *params)
+{
+	OutputLumpGraph::Node *pNode = ReadNode(pContext, params[1]);
+	if (!pNode)
+		return 0;
+
+	return pNode->numEdges;
+}
+
+cell_t GetOutputGraphEdge(IPluginContext *pContext, const cell_t *params)
+{
+	OutputLumpGraph::Edge *pEdge = ReadEdge(pContext, params[1], params[2]);
+	if (!pEdge)
+		return 0;
+
+	pContext->StringToLocal(params[3], params[4], g_LumpGraph.String(pEdge->output));
+	pContext->StringToLocal(params[5], params[6], g_LumpGraph.String(pEdge->target));
+	pContext->StringToLocal(params[7], params[8], g_LumpGraph.String(pEdge->targetInput));
+	pContext->StringToLocal(params[9], params[10], g_LumpGraph.String(pEdge->parameter));
+
+	cell_t *pDelay;
+	pContext->LocalToPhysAddr(params[11], &pDelay);
+	*pDelay = sp_ftoc(pEdge->delay);
+
+	return pEdge->timesToFire;
+}
+
+cell_t GetOutputGraphEdgeTargets(IPluginContext *pContext, const cell_t *params)
+{
+	OutputLumpGraph::Edge *pEdge = ReadEdge(pContext, params[1], params[2]);
+	if (!pEdge)
+		return 0;
+
+	cell_t *pNodes;
+	pContext->LocalToPhysAddr(params[3], &pNodes);
+
+	int count = 0;
+	for (int i = 0; i < pEdge->numTargets && count < params[4]; i++)
+		pNodes[count++] = g_LumpGraph.m_EdgeTargets[pEdge->firstTarget + i];
+
+	return count;
+}
+
+cell_t GetOutputGraphIncoming(IPluginContext *pContext, const cell_t *params)
+{
+	OutputLumpGraph::Node *pNode = ReadNode(pContext, params[1]);
+	if (!pNode)
+		return 0;
+
+	cell_t *pSources;
+	pContext->LocalToPhysAddr(params[2], &pSources);
+
+	int count = 0;
+	for (int i = 0; i < pNode->numIncoming && count < params[3]; i++)
+	{
+		int source = g_LumpGraph.m_Edges[g_LumpGraph.m_Incoming[pNode->firstIncoming + i]].source;
+
+		// Several edges of one source may target this node
+		bool seen = false;
+		for (int j = 0; j < count && !seen; j++)
+			seen = pSources[j] == source;
+
+		if (!seen)
+			pSources[count++] = source;
+	}
+
+	return count;
+}
+
+const sp_nativeinfo_t g_LumpGraphNatives[] =
+{
+	{ "IsOutputGraphReady",			IsOutputGraphReady },
+	{ "GetOutputGraphNodeCount",	GetOutputGraphNodeCount },
+	{ "FindOutputGraphNode",		FindOutputGraphNode },
+	{ "GetOutputGraphNode",			GetOutputGraphNode },
+	{ "GetOutputGraphEdgeCount",	GetOutputGraphEdgeCount },
+	{ "GetOutputGraphEdge",			GetOutputGraphEdge },
+	{ "GetOutputGraphEdgeTargets",	GetOutputGraphEdgeTargets },
+	{ "GetOutputGraphIncoming",		GetOutputGraphIncoming },
+	{ NULL, NULL },
+};
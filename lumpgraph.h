@@ -0,0 +1,133 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_LUMPGRAPH_H_
+#define _INCLUDE_OUTPUTINFO_LUMPGRAPH_H_
+
+/**
+ * @file lumpgraph.h
+ * @brief Output graph of the map's entity lump, built on a worker thread.
+ */
+
+#include "extension.h"
+#include <IThreader.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+ * The entity lump is copied in IServerGameDLL::LevelInit, before any entity
+ * spawns, and parsed on a worker thread into flat arrays: one node per lump
+ * entity, one edge per output keyvalue, with edge targets resolved to nodes.
+ * The graph reflects the map as compiled, not later edits. Queries made before
+ * the worker finishes wait for it.
+ */
+class OutputLumpGraph : public IThread
+{
+public:
+	struct Node
+	{
+		int classname;		/**< Offsets into m_Strings */
+		int targetname;
+		int hammerid;
+		int firstEdge;
+		int numEdges;
+		int firstIncoming;	/**< Range in m_Incoming of edges targeting this node */
+		int numIncoming;
+	};
+
+	struct Edge
+	{
+		int source;
+		int output;
+		int target;
+		int targetInput;
+		int parameter;
+		float delay;
+		int timesToFire;
+		int firstTarget;	/**< Range in m_EdgeTargets of resolved target nodes */
+		int numTargets;
+	};
+
+	OutputLumpGraph();
+
+	/**
+	 * @param late			Analyze the running map's lump now.
+	 */
+	void Init(bool late);
+	void Shutdown();
+
+	/**
+	 * @brief Starts analyzing a new entity lump, discarding the previous graph.
+	 */
+	void Analyze(const char *pszMapEntities);
+
+	bool IsReady() { return m_bReady; }
+
+	/**
+	 * @brief Waits for the worker if it is still running.
+	 *
+	 * @return				False if no lump was analyzed.
+	 */
+	bool WaitReady();
+
+	bool Hook_LevelInit(char const *pMapName, char const *pMapEntities, char const *pOldLevel, char const *pLandmarkName, bool loadGame, bool background);
+
+	const char *String(int offset) { return &m_Strings[offset]; }
+
+public: // IThread
+	void RunThread(IThreadHandle *pHandle);
+	void OnTerminate(IThreadHandle *pHandle, bool cancel);
+
+private:
+	void Join();
+	int AddString(const char *pszValue, size_t length);
+	void Parse();
+	void Resolve();
+
+public:
+	std::vector<Node> m_Nodes;
+	std::vector<Edge> m_Edges;
+	std::vector<int> m_EdgeTargets;
+	std::vector<int> m_Incoming;
+	std::vector<char> m_Strings;
+
+private:
+	std::string m_Lump;
+	IThreadHandle *m_pThread;
+	std::atomic<bool> m_bReady;
+	bool m_bHooked;
+};
+
+extern OutputLumpGraph g_LumpGraph;
+extern const sp_nativeinfo_t g_LumpGraphNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_LUMPGRAPH_H_
@@ -0,0 +1,938 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "outputgraph.h"
+#include "actionrefs.h"
+#include "outputkey.h"
+#include "rules.h"
+#include <ctype.h>
+#include <float.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_set>
+
+/**
+ * @file outputgraph.cpp
+ * @brief Reachability and loop analysis over the live action lists of all entities.
+ */
+
+OutputGraph g_OutputGraph;
+
+struct InputRelation
+{
+	const char *classname;	/**< nullptr for any class */
+	const char *input;
+	const char *outputs;	/**< Space separated; a trailing * matches a prefix */
+};
+
+// Inputs known to fire outputs of the entity receiving them. Anything else
+// (Enable, Kill, AddOutput...) is assumed not to continue the chain.
+static const InputRelation s_InputRelations[] =
+{
+	{ nullptr,				"FireUser1",			"OnUser1" },
+	{ nullptr,				"FireUser2",			"OnUser2" },
+	{ nullptr,				"FireUser3",			"OnUser3" },
+	{ nullptr,				"FireUser4",			"OnUser4" },
+	{ nullptr,				"Break",				"OnBreak" },
+	{ "logic_relay",		"Trigger",				"OnTrigger" },
+	{ "logic_timer",		"FireTimer",			"OnTimer OnTimerHigh OnTimerLow" },
+	{ "logic_branch",		"Test",					"OnTrue OnFalse" },
+	{ "logic_branch",		"SetValueTest",			"OnTrue OnFalse" },
+	{ "logic_branch",		"ToggleTest",			"OnTrue OnFalse" },
+	{ "logic_compare",		"Compare",				"OnLessThan OnEqualTo OnNotEqualTo OnGreaterThan" },
+	{ "logic_compare",		"SetValueCompare",		"OnLessThan OnEqualTo OnNotEqualTo OnGreaterThan" },
+	{ "logic_case",			"InValue",				"OnCase* OnDefault" },
+	{ "logic_case",			"PickRandom",			"OnCase*" },
+	{ "logic_case",			"PickRandomShuffle",	"OnCase*" },
+	{ "math_counter",		"Add",					"OutValue OnHitMin OnHitMax OnChangedFromMin OnChangedFromMax" },
+	{ "math_counter",		"Subtract",				"OutValue OnHitMin OnHitMax OnChangedFromMin OnChangedFromMax" },
+	{ "math_counter",		"Multiply",				"OutValue OnHitMin OnHitMax OnChangedFromMin OnChangedFromMax" },
+	{ "math_counter",		"Divide",				"OutValue OnHitMin OnHitMax OnChangedFromMin OnChangedFromMax" },
+	{ "math_counter",		"SetValue",				"OutValue OnHitMin OnHitMax OnChangedFromMin OnChangedFromMax" },
+	{ "math_counter",		"GetValue",				"OnGetValue" },
+	{ "func_button",		"Press",				"OnPressed" },
+	{ "func_door*",			"Open",					"OnOpen" },
+	{ "func_door*",			"Close",				"OnClose" },
+	{ "func_door*",			"Toggle",				"OnOpen OnClose" },
+	{ "point_template",		"ForceSpawn",			"OnEntitySpawned" },
+	{ "env_entity_maker",	"ForceSpawn",			"OnEntitySpawned" },
+	{ "trigger_*",			"TouchTest",			"OnTouching OnNotTouching" },
+	{ "filter_*",			"TestActivator",		"OnPass OnFail" },
+};
+
+static bool MatchName(const char *pattern, size_t length, const char *name)
+{
+	if (length > 0 && pattern[length - 1] == '*')
+		return strnicmp(pattern, name, length - 1) == 0;
+
+	return strlen(name) == length && strnicmp(pattern, name, length) == 0;
+}
+
+static bool InputFiresOutput(const char *pszClassname, const char *pszInput, const char *pszOutput)
+{
+	for (size_t i = 0; i < sizeof(s_InputRelations) / sizeof(s_InputRelations[0]); i++)
+	{
+		const InputRelation &relation = s_InputRelations[i];
+		if (stricmp(relation.input, pszInput) != 0)
+			continue;
+
+		if (relation.classname && !MatchName(relation.classname, strlen(relation.classname), pszClassname))
+			continue;
+
+		for (const char *p = relation.outputs; *p; )
+		{
+			const char *pEnd = strchr(p, ' ');
+			size_t length = pEnd ? pEnd - p : strlen(p);
+			if (MatchName(p, length, pszOutput))
+				return true;
+
+			p += length;
+			while (*p == ' ')
+				p++;
+		}
+	}
+
+	return false;
+}
+
+static std::string LowerCase(const char *pszValue)
+{
+	std::string lower(pszValue);
+	for (size_t i = 0; i < lower.size(); i++)
+		lower[i] = (char)tolower((unsigned char)lower[i]);
+
+	return lower;
+}
+
+static string_t GetEntityName(CBaseEntity *pEntity)
+{
+	static int s_NameOffset = -1;
+	if (s_NameOffset == -1)
+	{
+		sm_datatable_info_t info;
+		if (!gamehelpers->FindDataMapInfo(gamehelpers->GetDataMap(pEntity), "m_iName", &info))
+			return NULL_STRING;
+
+		s_NameOffset = info.actual_offset;
+	}
+
+	return *(string_t *)((intptr_t)pEntity + s_NameOffset);
+}
+
+OutputGraph::OutputGraph() :
+	m_Generation(1),
+	m_bBuilt(false)
+{
+}
+
+void OutputGraph::Init()
+{
+	if (g_pSDKHooks)
+		g_pSDKHooks->AddEntityListener(this);
+}
+
+void OutputGraph::Shutdown()
+{
+	if (g_pSDKHooks)
+		g_pSDKHooks->RemoveEntityListener(this);
+
+	Clear();
+}
+
+void OutputGraph::Clear()
+{
+	m_Nodes.clear();
+	m_FreeNodes.clear();
+	m_Index.clear();
+	m_Outputs.clear();
+	m_Names.clear();
+	m_Classnames.clear();
+	m_Pending.clear();
+	m_Loops.clear();
+	m_LoopSteps.clear();
+	m_Generation = 1;
+	m_bBuilt = false;
+}
+
+void OutputGraph::OnEntityCreated(CBaseEntity *pEntity, const char *classname)
+{
+	// Keyvalues and outputs aren't set up yet, the entity is read on the next query
+	if (m_bBuilt)
+		m_Pending.push_back(gamehelpers->EntityToReference(pEntity));
+}
+
+void OutputGraph::OnOutputChanged(CBaseEntityOutput *pOutput)
+{
+	auto it = m_Outputs.find(pOutput);
+	if (it != m_Outputs.end())
+		m_Nodes[it->second].dirty = true;
+}
+
+void OutputGraph::IndexName(int node, bool add)
+{
+	const Node &n = m_Nodes[node];
+
+	std::string keys[2] = { LowerCase(n.name.ToCStr()), LowerCase(n.pszClassname) };
+	std::unordered_map<std::string, std::vector<int>> *maps[2] = { &m_Names, &m_Classnames };
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (keys[i].empty())
+			continue;
+
+		if (add)
+		{
+			(*maps[i])[keys[i]].push_back(node);
+			continue;
+		}
+
+		auto it = maps[i]->find(keys[i]);
+		if (it == maps[i]->end())
+			continue;
+
+		std::vector<int> &nodes = it->second;
+		for (size_t j = 0; j < nodes.size(); j++)
+		{
+			if (nodes[j] == node)
+			{
+				nodes[j] = nodes.back();
+				nodes.pop_back();
+				break;
+			}
+		}
+
+		if (nodes.empty())
+			maps[i]->erase(it);
+	}
+}
+
+int OutputGraph::AddNode(CBaseEntity *pEntity)
+{
+	cell_t entref = gamehelpers->EntityToReference(pEntity);
+
+	auto it = m_Index.find(entref);
+	if (it != m_Index.end())
+		return it->second;
+
+	int node;
+	if (!m_FreeNodes.empty())
+	{
+		node = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+	}
+	else
+	{
+		node = (int)m_Nodes.size();
+		m_Nodes.emplace_back();
+	}
+
+	const char *pszClassname = gamehelpers->GetEntityClassname(pEntity);
+
+	Node &n = m_Nodes[node];
+	n.entref = entref;
+	n.pszClassname = pszClassname ? pszClassname : "";
+	n.name = GetEntityName(pEntity);
+	n.live = true;
+	n.dirty = true;
+	n.resolved = 0;
+	n.fields.clear();
+	n.edges.clear();
+	n.targets.clear();
+
+	const std::vector<OutputField> *pFields = GetOutputFields(pEntity);
+	if (pFields)
+	{
+		for (size_t i = 0; i < pFields->size(); i++)
+		{
+			Field field;
+			field.pOutput = (CBaseEntityOutput *)((intptr_t)pEntity + (*pFields)[i].offset);
+			field.pszOutput = (*pFields)[i].externalName;
+			field.pHead = NULL;
+			n.fields.push_back(field);
+
+			m_Outputs[field.pOutput] = node;
+		}
+	}
+
+	m_Index[entref] = node;
+	IndexName(node, true);
+	m_Generation++;
+
+	return node;
+}
+
+void OutputGraph::RemoveNode(int node)
+{
+	Node &n = m_Nodes[node];
+
+	IndexName(node, false);
+
+	// The memory may already belong to a new entity that took over the output
+	for (size_t i = 0; i < n.fields.size(); i++)
+	{
+		auto it = m_Outputs.find(n.fields[i].pOutput);
+		if (it != m_Outputs.end() && it->second == node)
+			m_Outputs.erase(it);
+	}
+
+	m_Index.erase(n.entref);
+
+	n.live = false;
+	n.fields.clear();
+	n.edges.clear();
+	n.targets.clear();
+
+	m_FreeNodes.push_back(node);
+	m_Generation++;
+}
+
+void OutputGraph::ReadNode(int node, CBaseEntity *pEntity)
+{
+	Node &n = m_Nodes[node];
+	n.edges.clear();
+
+	for (size_t i = 0; i < n.fields.size(); i++)
+	{
+		Field &field = n.fields[i];
+		field.pHead = field.pOutput->m_ActionList;
+
+		for (CEventAction *pAction = field.pHead; pAction != NULL; pAction = pAction->m_pNext)
+		{
+			if (pAction->m_nTimesToFire == 0)
+				continue;
+
+			Edge edge;
+			edge.pOutput = field.pOutput;
+			edge.pszOutput = field.pszOutput;
+			edge.pAction = pAction;
+			edge.stamp = pAction->m_iIDStamp;
+			edge.firstTarget = 0;
+			edge.numTargets = 0;
+			n.edges.push_back(edge);
+		}
+	}
+
+	n.dirty = false;
+	ResolveNode(node);
+}
+
+void OutputGraph::ResolveTarget(int node, const char *pszTarget, std::vector<int> &targets)
+{
+	if (pszTarget[0] == '\0')
+		return;
+
+	// !activator, !caller etc. are only known when the output fires
+	if (pszTarget[0] == '!')
+	{
+		if (stricmp(pszTarget, "!self") == 0)
+			targets.push_back(node);
+		return;
+	}
+
+	// Same lookup order as the game: targetname first, then classname
+	std::string key = LowerCase(pszTarget);
+	std::unordered_map<std::string, std::vector<int>> *maps[2] = { &m_Names, &m_Classnames };
+
+	for (int i = 0; i < 2; i++)
+	{
+		size_t size = targets.size();
+
+		if (key[key.size() - 1] == '*')
+		{
+			size_t prefix = key.size() - 1;
+			for (auto it = maps[i]->begin(); it != maps[i]->end(); ++it)
+			{
+				if (it->first.compare(0, prefix, key, 0, prefix) == 0)
+					targets.insert(targets.end(), it->second.begin(), it->second.end());
+			}
+		}
+		else
+		{
+			auto it = maps[i]->find(key);
+			if (it != maps[i]->end())
+				targets.insert(targets.end(), it->second.begin(), it->second.end());
+		}
+
+		if (targets.size() != size)
+			return;
+	}
+}
+
+void OutputGraph::ResolveNode(int node)
+{
+	Node &n = m_Nodes[node];
+	n.targets.clear();
+
+	for (size_t i = 0; i < n.edges.size(); i++)
+	{
+		Edge &edge = n.edges[i];
+		edge.firstTarget = (int)n.targets.size();
+		ResolveTarget(node, edge.pAction->m_iTarget.ToCStr(), n.targets);
+		edge.numTargets = (int)n.targets.size() - edge.firstTarget;
+	}
+
+	n.resolved = m_Generation;
+}
+
+bool OutputGraph::EnsureNode(int node)
+{
+	Node &n = m_Nodes[node];
+	if (!n.live)
+		return false;
+
+	// Catch list changes the game made itself: AddOutput inserts at the head,
+	// and actions running out of times to fire are freed.
+	for (size_t i = 0; !n.dirty && i < n.fields.size(); i++)
+	{
+		if (n.fields[i].pOutput->m_ActionList != n.fields[i].pHead)
+			n.dirty = true;
+	}
+	for (size_t i = 0; !n.dirty && i < n.edges.size(); i++)
+	{
+		const Edge &edge = n.edges[i];
+		if (edge.pAction->m_iIDStamp != edge.stamp || edge.pAction->m_nTimesToFire == 0)
+			n.dirty = true;
+	}
+
+	if (n.dirty)
+	{
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(n.entref);
+		if (!pEntity)
+		{
+			RemoveNode(node);
+			return false;
+		}
+
+		ReadNode(node, pEntity);
+	}
+	else if (n.resolved != m_Generation)
+	{
+		ResolveNode(node);
+	}
+
+	return true;
+}
+
+void OutputGraph::Rebuild()
+{
+	Clear();
+	m_bBuilt = true;
+
+	// Nodes are read lazily, so a reachability query only reads what it visits
+	for (CBaseEntity *pEntity = NextEntity(nullptr); pEntity != nullptr; pEntity = NextEntity(pEntity))
+		AddNode(pEntity);
+}
+
+void OutputGraph::Refresh()
+{
+	// Without the entity listener spawned entities can't be tracked
+	if (!m_bBuilt || !g_pSDKHooks)
+	{
+		Rebuild();
+		return;
+	}
+
+	for (size_t i = 0; i < m_Nodes.size(); i++)
+	{
+		Node &n = m_Nodes[i];
+		if (!n.live)
+			continue;
+
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(n.entref);
+		if (!pEntity)
+		{
+			RemoveNode((int)i);
+			continue;
+		}
+
+		string_t name = GetEntityName(pEntity);
+		if (name != n.name)
+		{
+			IndexName((int)i, false);
+			n.name = name;
+			IndexName((int)i, true);
+			m_Generation++;
+		}
+	}
+
+	for (size_t i = 0; i < m_Pending.size(); i++)
+	{
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(m_Pending[i]);
+		if (pEntity)
+			AddNode(pEntity);
+	}
+
+	m_Pending.clear();
+}
+
+size_t OutputGraph::NumEdges()
+{
+	size_t count = 0;
+	for (size_t i = 0; i < m_Nodes.size(); i++)
+		count += m_Nodes[i].edges.size();
+
+	return count;
+}
+
+int OutputGraph::Reach(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, std::vector<std::pair<cell_t, float>> &reached)
+{
+	Refresh();
+
+	int start = AddNode(pEntity);
+	if (!EnsureNode(start))
+		return 0;
+
+	// Dijkstra over actions, keyed by the time an action reaches its targets
+	typedef std::pair<float, std::pair<int, int>> Item;
+	std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+	std::unordered_set<CEventAction *> visited;
+	std::vector<bool> seen(m_Nodes.size(), false);
+	std::vector<int> targets;
+
+	const Node &first = m_Nodes[start];
+	for (size_t i = 0; i < first.edges.size(); i++)
+	{
+		if (first.edges[i].pOutput == pOutput)
+			queue.push(Item(first.edges[i].pAction->m_flDelay, std::make_pair(start, (int)i)));
+	}
+
+	while (!queue.empty())
+	{
+		Item item = queue.top();
+		queue.pop();
+
+		float time = item.first;
+		const Node &source = m_Nodes[item.second.first];
+		if (item.second.second >= (int)source.edges.size())
+			continue;
+
+		const Edge &edge = source.edges[item.second.second];
+		if (!visited.insert(edge.pAction).second)
+			continue;
+
+		// Ensuring a target may re-resolve the source, so work from a copy
+		targets.assign(source.targets.begin() + edge.firstTarget, source.targets.begin() + edge.firstTarget + edge.numTargets);
+
+		const char *pszInput = edge.pAction->m_iTargetInput.ToCStr();
+		for (size_t i = 0; i < targets.size(); i++)
+		{
+			int target = targets[i];
+			if (!EnsureNode(target))
+				continue;
+
+			const Node &n = m_Nodes[target];
+			if (!seen[target])
+			{
+				seen[target] = true;
+				reached.push_back(std::make_pair(n.entref, time));
+			}
+
+			for (size_t j = 0; j < n.edges.size(); j++)
+			{
+				if (InputFiresOutput(n.pszClassname, pszInput, n.edges[j].pszOutput))
+					queue.push(Item(time + n.edges[j].pAction->m_flDelay, std::make_pair(target, (int)j)));
+			}
+		}
+	}
+
+	return (int)reached.size();
+}
+
+int OutputGraph::FindLoops()
+{
+	Refresh();
+
+	m_Loops.clear();
+	m_LoopSteps.clear();
+
+	for (size_t i = 0; i < m_Nodes.size(); i++)
+		EnsureNode((int)i);
+
+	// Number every action, then link it to the actions its input can fire
+	m_EdgeIds.clear();
+	m_FirstEdgeId.assign(m_Nodes.size(), 0);
+	for (size_t i = 0; i < m_Nodes.size(); i++)
+	{
+		m_FirstEdgeId[i] = (int)m_EdgeIds.size();
+		for (size_t j = 0; j < m_Nodes[i].edges.size(); j++)
+			m_EdgeIds.push_back(std::make_pair((int)i, (int)j));
+	}
+
+	int count = (int)m_EdgeIds.size();
+
+	m_SuccStart.assign(count + 1, 0);
+	m_Succ.clear();
+	for (int id = 0; id < count; id++)
+	{
+		m_SuccStart[id] = (int)m_Succ.size();
+
+		const Node &source = m_Nodes[m_EdgeIds[id].first];
+		const Edge &edge = source.edges[m_EdgeIds[id].second];
+		const char *pszInput = edge.pAction->m_iTargetInput.ToCStr();
+
+		for (int i = 0; i < edge.numTargets; i++)
+		{
+			int target = source.targets[edge.firstTarget + i];
+			const Node &n = m_Nodes[target];
+			if (!n.live)
+				continue;
+
+			for (size_t j = 0; j < n.edges.size(); j++)
+			{
+				if (InputFiresOutput(n.pszClassname, pszInput, n.edges[j].pszOutput))
+					m_Succ.push_back(m_FirstEdgeId[target] + (int)j);
+			}
+		}
+	}
+	m_SuccStart[count] = (int)m_Succ.size();
+
+	// Tarjan's strongly connected components, iteratively
+	std::vector<int> index(count, -1), low(count, 0), stack, members;
+	std::vector<bool> onStack(count, false);
+	std::vector<std::pair<int, int>> calls;
+	int counter = 0, components = 0;
+
+	m_Component.assign(count, -1);
+	m_Dist.assign(count, FLT_MAX);
+	m_Parent.assign(count, -1);
+
+	for (int root = 0; root < count; root++)
+	{
+		if (index[root] != -1)
+			continue;
+
+		index[root] = low[root] = counter++;
+		stack.push_back(root);
+		onStack[root] = true;
+		calls.push_back(std::make_pair(root, m_SuccStart[root]));
+
+		while (!calls.empty())
+		{
+			int v = calls.back().first;
+			if (calls.back().second < m_SuccStart[v + 1])
+			{
+				int w = m_Succ[calls.back().second++];
+				if (index[w] == -1)
+				{
+					index[w] = low[w] = counter++;
+					stack.push_back(w);
+					onStack[w] = true;
+					calls.push_back(std::make_pair(w, m_SuccStart[w]));
+				}
+				else if (onStack[w])
+				{
+					low[v] = std::min(low[v], index[w]);
+				}
+				continue;
+			}
+
+			calls.pop_back();
+			if (!calls.empty())
+			{
+				int u = calls.back().first;
+				low[u] = std::min(low[u], low[v]);
+			}
+
+			if (low[v] != index[v])
+				continue;
+
+			members.clear();
+			int w;
+			do
+			{
+				w = stack.back();
+				stack.pop_back();
+				onStack[w] = false;
+				m_Component[w] = components;
+				members.push_back(w);
+			} while (w != v);
+
+			bool selfLoop = false;
+			for (int i = m_SuccStart[v]; i < m_SuccStart[v + 1]; i++)
+				selfLoop |= m_Succ[i] == v;
+
+			if (members.size() > 1 || selfLoop)
+				AddLoop(members, components);
+
+			components++;
+		}
+	}
+
+	return (int)m_Loops.size();
+}
+
+void OutputGraph::AddLoop(const std::vector<int> &members, int component)
+{
+	auto delayOf = [this](int id) {
+		return m_Nodes[m_EdgeIds[id].first].edges[m_EdgeIds[id].second].pAction->m_flDelay;
+	};
+
+	// Cheapest cycle through each member in turn. A cycle through an earlier
+	// start was already found from it, so earlier starts are fenced off with
+	// a negative distance no relaxation can beat (delays are never negative).
+	typedef std::pair<float, int> Item;
+	std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+
+	float best = FLT_MAX;
+	std::vector<int> path;
+
+	for (size_t k = 0; k < members.size(); k++)
+	{
+		int start = members[k];
+		int last = -1;
+
+		m_Dist[start] = delayOf(start);
+		queue.push(Item(m_Dist[start], start));
+
+		while (!queue.empty())
+		{
+			Item item = queue.top();
+			queue.pop();
+
+			int u = item.second;
+			if (item.first > m_Dist[u] || item.first >= best)
+				continue;
+
+			for (int i = m_SuccStart[u]; i < m_SuccStart[u + 1]; i++)
+			{
+				int w = m_Succ[i];
+				if (m_Component[w] != component)
+					continue;
+
+				if (w == start)
+				{
+					if (m_Dist[u] < best)
+					{
+						best = m_Dist[u];
+						last = u;
+					}
+					continue;
+				}
+
+				float dist = m_Dist[u] + delayOf(w);
+				if (dist < m_Dist[w])
+				{
+					m_Dist[w] = dist;
+					m_Parent[w] = u;
+					queue.push(Item(dist, w));
+				}
+			}
+		}
+
+		while (!queue.empty())
+			queue.pop();
+
+		if (last != -1)
+		{
+			path.clear();
+			for (int id = last; id != -1; id = (id == start) ? -1 : m_Parent[id])
+				path.push_back(id);
+		}
+
+		for (size_t i = k + 1; i < members.size(); i++)
+		{
+			m_Dist[members[i]] = FLT_MAX;
+			m_Parent[members[i]] = -1;
+		}
+
+		m_Dist[start] = -1.0f;
+	}
+
+	Loop loop;
+	loop.firstStep = (int)m_LoopSteps.size();
+	loop.delay = best;
+
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		const Node &n = m_Nodes[m_EdgeIds[path[i]].first];
+		const Edge &edge = n.edges[m_EdgeIds[path[i]].second];
+
+		LoopStep step;
+		step.entref = n.entref;
+		step.pOutput = edge.pOutput;
+		step.pAction = edge.pAction;
+		step.stamp = edge.stamp;
+		m_LoopSteps.push_back(step);
+	}
+
+	std::reverse(m_LoopSteps.begin() + loop.firstStep, m_LoopSteps.end());
+	loop.numSteps = (int)m_LoopSteps.size() - loop.firstStep;
+
+	// A cycle of zero delay actions exists if peeling off the ones without a
+	// zero delay predecessor doesn't consume all of them (Kahn's algorithm)
+	std::unordered_map<int, int> indegree;
+	for (size_t i = 0; i < members.size(); i++)
+	{
+		if (delayOf(members[i]) == 0.0f)
+			indegree[members[i]];
+	}
+	for (auto it = indegree.begin(); it != indegree.end(); ++it)
+	{
+		for (int i = m_SuccStart[it->first]; i < m_SuccStart[it->first + 1]; i++)
+		{
+			auto w = indegree.find(m_Succ[i]);
+			if (w != indegree.end() && m_Component[m_Succ[i]] == component)
+				w->second++;
+		}
+	}
+
+	std::vector<int> ready;
+	for (auto it = indegree.begin(); it != indegree.end(); ++it)
+	{
+		if (it->second == 0)
+			ready.push_back(it->first);
+	}
+
+	size_t removed = 0;
+	while (!ready.empty())
+	{
+		int u = ready.back();
+		ready.pop_back();
+		removed++;
+
+		for (int i = m_SuccStart[u]; i < m_SuccStart[u + 1]; i++)
+		{
+			auto w = indegree.find(m_Succ[i]);
+			if (w != indegree.end() && m_Component[m_Succ[i]] == component && --w->second == 0)
+				ready.push_back(w->first);
+		}
+	}
+
+	loop.zeroDelay = removed != indegree.size();
+	m_Loops.push_back(loop);
+
+	for (size_t i = 0; i < members.size(); i++)
+	{
+		m_Dist[members[i]] = FLT_MAX;
+		m_Parent[members[i]] = -1;
+	}
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputReachable(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+	if (pEntityOutput == NULL)
+		return 0;
+
+	cell_t *pEntities, *pDelays;
+	pContext->LocalToPhysAddr(params[3], &pEntities);
+	pContext->LocalToPhysAddr(params[4], &pDelays);
+
+	std::vector<std::pair<cell_t, float>> reached;
+	g_OutputGraph.Reach(pEntity, pEntityOutput, reached);
+
+	int count = std::min((int)reached.size(), (int)params[5]);
+	for (int i = 0; i < count; i++)
+	{
+		pEntities[i] = gamehelpers->ReferenceToBCompatRef(reached[i].first);
+		pDelays[i] = sp_ftoc(reached[i].second);
+	}
+
+	return count < 0 ? 0 : count;
+}
+
+cell_t FindOutputLoops(IPluginContext *pContext, const cell_t *params)
+{
+	return g_OutputGraph.FindLoops();
+}
+
+static const OutputGraph::Loop *ReadLoop(IPluginContext *pContext, cell_t loop)
+{
+	if (loop < 0 || loop >= (cell_t)g_OutputGraph.m_Loops.size())
+	{
+		pContext->ThrowNativeError("Invalid loop %d (count: %d)", loop, (int)g_OutputGraph.m_Loops.size());
+		return nullptr;
+	}
+
+	return &g_OutputGraph.m_Loops[loop];
+}
+
+cell_t GetOutputLoop(IPluginContext *pContext, const cell_t *params)
+{
+	const OutputGraph::Loop *pLoop = ReadLoop(pContext, params[1]);
+	if (!pLoop)
+		return 0;
+
+	cell_t *pEntities, *pDelay, *pZeroDelay;
+	pContext->LocalToPhysAddr(params[2], &pEntities);
+	pContext->LocalToPhysAddr(params[4], &pDelay);
+	pContext->LocalToPhysAddr(params[5], &pZeroDelay);
+
+	for (int i = 0; i < pLoop->numSteps && i < params[3]; i++)
+		pEntities[i] = gamehelpers->ReferenceToBCompatRef(g_OutputGraph.m_LoopSteps[pLoop->firstStep + i].entref);
+
+	*pDelay = sp_ftoc(pLoop->delay);
+	*pZeroDelay = pLoop->zeroDelay;
+
+	return pLoop->numSteps;
+}
+
+cell_t GetOutputLoopAction(IPluginContext *pContext, const cell_t *params)
+{
+	const OutputGraph::Loop *pLoop = ReadLoop(pContext, params[1]);
+	if (!pLoop)
+		return 0;
+
+	if (params[2] < 0 || params[2] >= pLoop->numSteps)
+	{
+		return pContext->ThrowNativeError("Invalid loop step %d (count: %d)", params[2], pLoop->numSteps);
+	}
+
+	const OutputGraph::LoopStep &step = g_OutputGraph.m_LoopSteps[pLoop->firstStep + params[2]];
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(step.entref);
+	if (!pEntity || step.pAction->m_iIDStamp != step.stamp || step.pAction->m_nTimesToFire == 0)
+		return 0;
+
+	return g_ActionRefs.Register(pEntity, step.pOutput, step.pAction);
+}
+
+cell_t RebuildOutputGraph(IPluginContext *pContext, const cell_t *params)
+{
+	g_OutputGraph.Rebuild();
+	return g_OutputGraph.NumNodes();
+}
+
+const sp_nativeinfo_t g_OutputGraphNatives[] =
+{
+	{ "GetOutputReachable",		GetOutputReachable<ReadOutputByName> },
+	{ "OutputKey.GetReachable",	GetOutputReachable<ReadOutputByKey> },
+	{ "FindOutputLoops",		FindOutputLoops },
+	{ "GetOutputLoop",			GetOutputLoop },
+	{ "GetOutputLoopAction",	GetOutputLoopAction },
+	{ "RebuildOutputGraph",		RebuildOutputGraph },
+	{ NULL, NULL },
+};
@@ -0,0 +1,187 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_OUTPUTGRAPH_H_
+#define _INCLUDE_OUTPUTINFO_OUTPUTGRAPH_H_
+
+/**
+ * @file outputgraph.h
+ * @brief Reachability and loop analysis over the live action lists of all entities.
+ */
+
+#include "extension.h"
+#include "entityoutput.h"
+#include <ISDKHooks.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * One node per entity, holding its actions with their targets resolved to
+ * nodes. The graph is built on the first query of a map and kept up to date
+ * incrementally: our edit natives mark the owning node dirty, spawned entities
+ * are picked up from the SDKHooks entity listener, and before each query nodes
+ * are checked for removal, renames and list heads changed by the game itself.
+ *
+ * An action reaching an entity only continues through that entity's outputs
+ * if a table of known input to output relations (e.g. logic_relay's Trigger
+ * fires OnTrigger) says the input can fire them.
+ */
+class OutputGraph : public ISMEntityListener
+{
+public:
+	struct Edge
+	{
+		CBaseEntityOutput *pOutput;
+		const char *pszOutput;		/**< External name, e.g. OnTrigger */
+		CEventAction *pAction;
+		int stamp;
+		int firstTarget;			/**< Range in the node's m_Targets */
+		int numTargets;
+	};
+
+	struct Field
+	{
+		CBaseEntityOutput *pOutput;
+		const char *pszOutput;
+		CEventAction *pHead;		/**< Action list head when the node was read */
+	};
+
+	struct Node
+	{
+		cell_t entref;
+		const char *pszClassname;
+		string_t name;
+		bool live;
+		bool dirty;
+		unsigned int resolved;		/**< m_Generation the targets were resolved against */
+		std::vector<Field> fields;
+		std::vector<Edge> edges;
+		std::vector<int> targets;
+	};
+
+	struct LoopStep
+	{
+		cell_t entref;
+		CBaseEntityOutput *pOutput;
+		CEventAction *pAction;
+		int stamp;
+	};
+
+	struct Loop
+	{
+		int firstStep;
+		int numSteps;
+		float delay;				/**< Total delay of the steps, once around */
+		bool zeroDelay;				/**< The loop contains a cycle without any delay */
+	};
+
+	OutputGraph();
+
+	void Init();
+	void Shutdown();
+	void Clear();
+
+	/**
+	 * @brief Marks the node owning an output for re-reading.
+	 */
+	void OnOutputChanged(CBaseEntityOutput *pOutput);
+
+	/**
+	 * @brief Discards the graph and reads every entity again.
+	 */
+	void Rebuild();
+
+	/**
+	 * @brief Finds every entity an output of an entity can reach, with the
+	 * earliest delay it is reached after.
+	 *
+	 * @param reached		Receives entity references and delays, in order
+	 *						of increasing delay.
+	 * @return				Number of entities reached.
+	 */
+	int Reach(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, std::vector<std::pair<cell_t, float>> &reached);
+
+	/**
+	 * @brief Finds every loop (strongly connected group of actions) in the graph.
+	 * The results are kept in m_Loops and m_LoopSteps until the next call.
+	 *
+	 * @return				Number of loops.
+	 */
+	int FindLoops();
+
+	size_t NumNodes() { return m_Index.size(); }
+	size_t NumEdges();
+
+public: // ISMEntityListener
+	void OnEntityCreated(CBaseEntity *pEntity, const char *classname);
+
+private:
+	void Refresh();
+	int AddNode(CBaseEntity *pEntity);
+	void RemoveNode(int node);
+	void ReadNode(int node, CBaseEntity *pEntity);
+	void ResolveNode(int node);
+	bool EnsureNode(int node);
+	void ResolveTarget(int node, const char *pszTarget, std::vector<int> &targets);
+	void IndexName(int node, bool add);
+	void AddLoop(const std::vector<int> &members, int component);
+
+public:
+	std::vector<Node> m_Nodes;
+	std::vector<Loop> m_Loops;
+	std::vector<LoopStep> m_LoopSteps;
+
+private:
+	std::vector<int> m_FreeNodes;
+	std::unordered_map<cell_t, int> m_Index;
+	std::unordered_map<CBaseEntityOutput *, int> m_Outputs;
+	std::unordered_map<std::string, std::vector<int>> m_Names;
+	std::unordered_map<std::string, std::vector<int>> m_Classnames;
+	std::vector<cell_t> m_Pending;
+
+	// Scratch state of FindLoops, indexed by edge id
+	std::vector<std::pair<int, int>> m_EdgeIds;		/**< Node and edge index */
+	std::vector<int> m_FirstEdgeId;					/**< Per node */
+	std::vector<int> m_SuccStart;
+	std::vector<int> m_Succ;
+	std::vector<int> m_Component;
+	std::vector<float> m_Dist;
+	std::vector<int> m_Parent;
+
+	unsigned int m_Generation;
+	bool m_bBuilt;
+};
+
+extern OutputGraph g_OutputGraph;
+extern const sp_nativeinfo_t g_OutputGraphNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_OUTPUTGRAPH_H_
@@ -0,0 +1,193 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "outputinfoapi.h"
+#include "entityoutput.h"
+#include "stringpool.h"
+
+/**
+ * @file outputinfoapi.cpp
+ * @brief IOutputInfo, shared with other extensions through sharesys.
+ */
+
+OutputInfoApi g_OutputInfoApi;
+
+static string_t AllocOptionalString(const char *pszValue)
+{
+	return AllocPooledString(pszValue ? pszValue : "");
+}
+
+CBaseEntityOutput *OutputInfoApi::FindOutput(CBaseEntity *pEntity, const char *pszOutput)
+{
+	return GetOutput(pEntity, pszOutput);
+}
+
+int OutputInfoApi::GetActionCount(CBaseEntityOutput *pOutput)
+{
+	return pOutput->NumberOfElements();
+}
+
+CEventAction *OutputInfoApi::GetFirstAction(CBaseEntityOutput *pOutput)
+{
+	return pOutput->m_ActionList;
+}
+
+CEventAction *OutputInfoApi::GetNextAction(CEventAction *pAction)
+{
+	return pAction->m_pNext;
+}
+
+CEventAction *OutputInfoApi::GetAction(CBaseEntityOutput *pOutput, int index)
+{
+	if (index < 0)
+		return nullptr;
+
+	CEventAction *pAction = pOutput->m_ActionList;
+	for (int i = 0; i < index && pAction != NULL; i++)
+		pAction = pAction->m_pNext;
+
+	return pAction;
+}
+
+void OutputInfoApi::GetActionData(CEventAction *pAction, OutputActionData *pData)
+{
+	pData->target = pAction->m_iTarget.ToCStr();
+	pData->targetInput = pAction->m_iTargetInput.ToCStr();
+	pData->parameter = pAction->m_iParameter.ToCStr();
+	pData->delay = pAction->m_flDelay;
+	pData->timesToFire = pAction->m_nTimesToFire;
+}
+
+int OutputInfoApi::GetActionStamp(CEventAction *pAction)
+{
+	return pAction->m_iIDStamp;
+}
+
+unsigned int OutputInfoApi::GetListVersion(CBaseEntityOutput *pOutput)
+{
+	return GetOutputListVersion(pOutput);
+}
+
+void OutputInfoApi::SetActionTarget(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction, const char *pszTarget)
+{
+	pAction->m_iTarget = AllocOptionalString(pszTarget);
+	OnOutputActionChanged(pEntity, pOutput, pAction);
+}
+
+void OutputInfoApi::SetActionTargetInput(CEventAction *pAction, const char *pszTargetInput)
+{
+	pAction->m_iTargetInput = AllocOptionalString(pszTargetInput);
+}
+
+void OutputInfoApi::SetActionParameter(CEventAction *pAction, const char *pszParameter)
+{
+	pAction->m_iParameter = AllocOptionalString(pszParameter);
+}
+
+void OutputInfoApi::SetActionDelay(CEventAction *pAction, float flDelay)
+{
+	pAction->m_flDelay = flDelay;
+}
+
+void OutputInfoApi::SetActionTimesToFire(CEventAction *pAction, int nTimesToFire)
+{
+	pAction->m_nTimesToFire = nTimesToFire;
+}
+
+bool OutputInfoApi::CanAllocateActions()
+{
+	return true;
+}
+
+CEventAction *OutputInfoApi::InsertAction(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, const OutputActionData &data, int index)
+{
+	if (index < 0)
+		return nullptr;
+
+	// Find the insertion point first so a bad index doesn't cost an allocation
+	CEventAction *pPrev = nullptr;
+	for (int i = 0; i < index; i++)
+	{
+		CEventAction *pNext = pPrev ? pPrev->m_pNext : pOutput->m_ActionList;
+		if (pNext == NULL)
+			return nullptr;
+
+		pPrev = pNext;
+	}
+
+	CEventAction *pNewAction = new CEventAction;
+	pNewAction->m_iTarget = AllocOptionalString(data.target);
+	pNewAction->m_iTargetInput = AllocOptionalString(data.targetInput);
+	pNewAction->m_iParameter = AllocOptionalString(data.parameter);
+	pNewAction->m_flDelay = data.delay;
+	pNewAction->m_nTimesToFire = data.timesToFire;
+
+	if (pPrev == nullptr)
+	{
+		pOutput->AddEventAction(pNewAction);
+	}
+	else
+	{
+		pNewAction->m_pNext = pPrev->m_pNext;
+		pPrev->m_pNext = pNewAction;
+	}
+
+	OnOutputListChanged(pOutput);
+	OnOutputActionChanged(pEntity, pOutput, pNewAction);
+
+	return pNewAction;
+}
+
+bool OutputInfoApi::RemoveAction(CBaseEntityOutput *pOutput, CEventAction *pAction)
+{
+	CEventAction *pPrev = nullptr;
+	for (CEventAction *pCur = pOutput->m_ActionList; pCur != NULL; pPrev = pCur, pCur = pCur->m_pNext)
+	{
+		if (pCur != pAction)
+			continue;
+
+		if (pPrev != nullptr)
+			pPrev->m_pNext = pCur->m_pNext;
+		else
+			pOutput->m_ActionList = pCur->m_pNext;
+
+		delete pCur;
+		OnOutputListChanged(pOutput);
+		return true;
+	}
+
+	return false;
+}
+
+int OutputInfoApi::ClearOutput(CBaseEntityOutput *pOutput)
+{
+	return FreeOutputActions(pOutput);
+}
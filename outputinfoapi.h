@@ -0,0 +1,67 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_OUTPUTINFOAPI_H_
+#define _INCLUDE_OUTPUTINFO_OUTPUTINFOAPI_H_
+
+/**
+ * @file outputinfoapi.h
+ * @brief IOutputInfo, shared with other extensions through sharesys.
+ */
+
+#include "extension.h"
+#include "IOutputInfo.h"
+
+class OutputInfoApi : public IOutputInfo
+{
+public: // IOutputInfo
+	CBaseEntityOutput *FindOutput(CBaseEntity *pEntity, const char *pszOutput);
+	int GetActionCount(CBaseEntityOutput *pOutput);
+	CEventAction *GetFirstAction(CBaseEntityOutput *pOutput);
+	CEventAction *GetNextAction(CEventAction *pAction);
+	CEventAction *GetAction(CBaseEntityOutput *pOutput, int index);
+	void GetActionData(CEventAction *pAction, OutputActionData *pData);
+	int GetActionStamp(CEventAction *pAction);
+	unsigned int GetListVersion(CBaseEntityOutput *pOutput);
+	void SetActionTarget(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction, const char *pszTarget);
+	void SetActionTargetInput(CEventAction *pAction, const char *pszTargetInput);
+	void SetActionParameter(CEventAction *pAction, const char *pszParameter);
+	void SetActionDelay(CEventAction *pAction, float flDelay);
+	void SetActionTimesToFire(CEventAction *pAction, int nTimesToFire);
+	bool CanAllocateActions();
+	CEventAction *InsertAction(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, const OutputActionData &data, int index);
+	bool RemoveAction(CBaseEntityOutput *pOutput, CEventAction *pAction);
+	int ClearOutput(CBaseEntityOutput *pOutput);
+};
+
+extern OutputInfoApi g_OutputInfoApi;
+
+#endif // _INCLUDE_OUTPUTINFO_OUTPUTINFOAPI_H_
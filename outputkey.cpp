@@ -0,0 +1,195 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "outputkey.h"
+#include "entityoutput.h"
+
+/**
+ * @file outputkey.cpp
+ * @brief Precompiled output names, resolved once per datamap.
+ */
+
+OutputKeyManager g_OutputKeys;
+
+int OutputKey::FindOffset(datamap_t *pMap)
+{
+	// An entity class rarely shares a key with more than a handful of others,
+	// so a linear scan beats hashing here.
+	for (size_t i = 0; i < m_Slots.size(); i++)
+	{
+		if (m_Slots[i].pMap == pMap)
+			return m_Slots[i].offset;
+	}
+
+	Slot slot;
+	slot.pMap = pMap;
+	slot.offset = FindOutputOffset(pMap, m_Name.c_str());
+
+	m_Slots.push_back(slot);
+	return slot.offset;
+}
+
+CBaseEntityOutput *OutputKey::Resolve(CBaseEntity *pEntity)
+{
+	if (!m_Classname.empty())
+	{
+		const char *pszClassname = gamehelpers->GetEntityClassname(pEntity);
+		if (!pszClassname || strcmp(pszClassname, m_Classname.c_str()) != 0)
+			return nullptr;
+	}
+
+	datamap_t *pMap = gamehelpers->GetDataMap(pEntity);
+	if (!pMap)
+		return nullptr;
+
+	int offset = FindOffset(pMap);
+	if (offset == -1)
+		return nullptr;
+
+	return (CBaseEntityOutput *)((intptr_t)pEntity + offset);
+}
+
+bool OutputKeyManager::Init(char *error, size_t maxlength)
+{
+	HandleError err;
+	m_Type = handlesys->CreateType("OutputKey", this, 0, NULL, NULL, myself->GetIdentity(), &err);
+	if (m_Type == 0)
+	{
+		snprintf(error, maxlength, "Failed to create OutputKey handle type (error %d)", err);
+		return false;
+	}
+
+	return true;
+}
+
+void OutputKeyManager::Shutdown()
+{
+	handlesys->RemoveType(m_Type, myself->GetIdentity());
+}
+
+OutputKey *OutputKeyManager::ReadKey(IPluginContext *pContext, cell_t hndl)
+{
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	OutputKey *pKey;
+	HandleError err = handlesys->ReadHandle(static_cast<Handle_t>(hndl), m_Type, &sec, (void **)&pKey);
+	if (err != HandleError_None)
+	{
+		pContext->ThrowNativeError("Invalid OutputKey handle %x (error %d)", hndl, err);
+		return nullptr;
+	}
+
+	return pKey;
+}
+
+void OutputKeyManager::OnHandleDestroy(HandleType_t type, void *object)
+{
+	delete (OutputKey *)object;
+}
+
+bool ReadOutputByName(IPluginContext *pContext, const cell_t *params, CBaseEntity **ppEntity, CBaseEntityOutput **ppOutput)
+{
+	char *pOutput;
+	pContext->LocalToString(params[2], &pOutput);
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[1]);
+	if (!pEntity)
+	{
+		pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[1]), params[1]);
+		return false;
+	}
+
+	*ppEntity = pEntity;
+	*ppOutput = GetOutput(pEntity, pOutput);
+	return true;
+}
+
+bool ReadOutputByKey(IPluginContext *pContext, const cell_t *params, CBaseEntity **ppEntity, CBaseEntityOutput **ppOutput)
+{
+	OutputKey *pKey = g_OutputKeys.ReadKey(pContext, params[1]);
+	if (!pKey)
+		return false;
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(params[2]);
+	if (!pEntity)
+	{
+		pContext->ThrowNativeError("Invalid Entity index %i (%i)", gamehelpers->ReferenceToIndex(params[2]), params[2]);
+		return false;
+	}
+
+	*ppEntity = pEntity;
+	*ppOutput = pKey->Resolve(pEntity);
+	return true;
+}
+
+cell_t OutputKey_OutputKey(IPluginContext *pContext, const cell_t *params)
+{
+	char *pOutput, *pClassname;
+	pContext->LocalToString(params[1], &pOutput);
+	pContext->LocalToString(params[2], &pClassname);
+
+	if (!pOutput[0])
+	{
+		return pContext->ThrowNativeError("Output name must not be empty");
+	}
+
+	OutputKey *pKey = new OutputKey;
+	pKey->m_Name = pOutput;
+	pKey->m_Classname = pClassname;
+
+	HandleError err;
+	Handle_t hndl = handlesys->CreateHandle(g_OutputKeys.m_Type, pKey, pContext->GetIdentity(), myself->GetIdentity(), &err);
+	if (hndl == BAD_HANDLE)
+	{
+		delete pKey;
+		return pContext->ThrowNativeError("Unable to create OutputKey handle (error %d)", err);
+	}
+
+	return hndl;
+}
+
+cell_t OutputKey_GetName(IPluginContext *pContext, const cell_t *params)
+{
+	OutputKey *pKey = g_OutputKeys.ReadKey(pContext, params[1]);
+	if (!pKey)
+		return 0;
+
+	size_t length;
+	pContext->StringToLocalUTF8(params[2], params[3], pKey->m_Name.c_str(), &length);
+	return length;
+}
+
+const sp_nativeinfo_t g_OutputKeyNatives[] =
+{
+	{ "OutputKey.OutputKey",	OutputKey_OutputKey },
+	{ "OutputKey.GetName",		OutputKey_GetName },
+	{ NULL, NULL },
+};
@@ -0,0 +1,111 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_OUTPUTKEY_H_
+#define _INCLUDE_OUTPUTINFO_OUTPUTKEY_H_
+
+/**
+ * @file outputkey.h
+ * @brief Precompiled output names, resolved once per datamap.
+ */
+
+#include "extension.h"
+#include <string>
+#include <vector>
+
+class CBaseEntityOutput;
+
+/**
+ * An output name, optionally restricted to one classname, that remembers
+ * where the output lives in every datamap it has been looked up against.
+ * Datamaps are static data of the game binary, so slots are never flushed.
+ */
+class OutputKey
+{
+public:
+	/**
+	 * @brief Finds the output on an entity.
+	 *
+	 * @return				The output, or nullptr if the entity has no such
+	 *						output or is not of the key's class.
+	 */
+	CBaseEntityOutput *Resolve(CBaseEntity *pEntity);
+
+private:
+	struct Slot
+	{
+		datamap_t *pMap;
+		int offset;				/**< -1 when the datamap has no such output */
+	};
+
+	int FindOffset(datamap_t *pMap);
+
+public:
+	std::string m_Name;
+	std::string m_Classname;	/**< empty for any class */
+
+private:
+	std::vector<Slot> m_Slots;
+};
+
+class OutputKeyManager : public IHandleTypeDispatch
+{
+public:
+	bool Init(char *error, size_t maxlength);
+	void Shutdown();
+
+	OutputKey *ReadKey(IPluginContext *pContext, cell_t hndl);
+
+public: // IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object);
+
+public:
+	HandleType_t m_Type;
+};
+
+/**
+ * Reads the entity and output a native operates on. Natives taking an output
+ * are written once against this and registered twice: with ReadOutputByName
+ * for (entity, const char[] output, ...) and with ReadOutputByKey for the
+ * OutputKey method, where params[1] is the key and params[2] the entity.
+ *
+ * Throws and returns false on an invalid entity or key; *ppOutput is set to
+ * nullptr if the entity has no such output.
+ */
+typedef bool (*OutputParamReader)(IPluginContext *pContext, const cell_t *params, CBaseEntity **ppEntity, CBaseEntityOutput **ppOutput);
+
+bool ReadOutputByName(IPluginContext *pContext, const cell_t *params, CBaseEntity **ppEntity, CBaseEntityOutput **ppOutput);
+bool ReadOutputByKey(IPluginContext *pContext, const cell_t *params, CBaseEntity **ppEntity, CBaseEntityOutput **ppOutput);
+
+extern OutputKeyManager g_OutputKeys;
+extern const sp_nativeinfo_t g_OutputKeyNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_OUTPUTKEY_H_
@@ -0,0 +1,223 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "profiler.h"
+#include "entityoutput.h"
+#include "firehooks.h"
+#include <algorithm>
+#include <string.h>
+
+/**
+ * @file profiler.cpp
+ * @brief Per-output fire counters and timings, collected from the FireOutput detour.
+ */
+
+OutputProfiler g_OutputProfiler;
+
+OutputProfiler::OutputProfiler() :
+	m_Dropped(0),
+	m_Used(0),
+	m_bEnabled(false)
+{
+	memset(m_Table, 0, sizeof(m_Table));
+}
+
+bool OutputProfiler::SetEnabled(bool enable)
+{
+	if (enable && !g_FireHooks.IsAvailable())
+		return false;
+
+	m_bEnabled = enable;
+	return true;
+}
+
+void OutputProfiler::Reset()
+{
+	memset(m_Table, 0, sizeof(m_Table));
+	m_Used = 0;
+	m_Dropped = 0;
+	m_Ranking.clear();
+}
+
+OutputProfiler::Entry *OutputProfiler::Find(CBaseEntityOutput *pOutput, CBaseEntity *pCaller)
+{
+	cell_t entref = pCaller ? gamehelpers->EntityToReference(pCaller) : 0;
+
+	size_t slot = (((uintptr_t)pOutput >> 2) * 2654435761u) & (kCapacity - 1);
+	for (size_t probe = 0; probe < kCapacity; probe++)
+	{
+		Entry &entry = m_Table[slot];
+		if (entry.pOutput == pOutput && entry.entref == entref)
+			return &entry;
+
+		if (entry.pOutput == nullptr)
+		{
+			if (m_Used >= kCapacity * 3 / 4)
+				break;
+
+			entry.pOutput = pOutput;
+			entry.entref = entref;
+			m_Used++;
+			return &entry;
+		}
+
+		slot = (slot + 1) & (kCapacity - 1);
+	}
+
+	m_Dropped++;
+	return nullptr;
+}
+
+size_t OutputProfiler::Rank()
+{
+	m_Ranking.clear();
+	m_Ranking.reserve(m_Used);
+
+	for (size_t i = 0; i < kCapacity; i++)
+	{
+		if (m_Table[i].pOutput != nullptr)
+			m_Ranking.push_back(&m_Table[i]);
+	}
+
+	std::sort(m_Ranking.begin(), m_Ranking.end(), [](const Entry *a, const Entry *b) {
+		return a->nanoseconds > b->nanoseconds;
+	});
+
+	return m_Ranking.size();
+}
+
+const OutputProfiler::Entry *OutputProfiler::GetRanked(size_t rank)
+{
+	if (rank >= m_Ranking.size())
+		return nullptr;
+
+	return m_Ranking[rank];
+}
+
+void OutputProfiler::Print(size_t count)
+{
+	size_t total = Rank();
+
+	rootconsole->ConsolePrint("[OutputInfo] Output profile (%s, %u outputs, %u dropped):",
+		m_bEnabled ? "running" : "stopped", (unsigned int)total, m_Dropped);
+	rootconsole->ConsolePrint("  %-6s %-32s %-24s %8s %8s %10s %9s",
+		"Entity", "Classname", "Output", "Fires", "Actions", "Total ms", "Avg us");
+
+	for (size_t i = 0; i < count && i < total; i++)
+	{
+		const Entry *pEntry = m_Ranking[i];
+
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(pEntry->entref);
+		const char *pszClassname = pEntity ? gamehelpers->GetEntityClassname(pEntity) : nullptr;
+		const char *pszOutput = pEntity ? GetOutputName(pEntity, pEntry->pOutput) : nullptr;
+
+		rootconsole->ConsolePrint("  %-6d %-32s %-24s %8u %8u %10.3f %9.2f",
+			pEntity ? gamehelpers->EntityToBCompatRef(pEntity) : -1,
+			pszClassname ? pszClassname : "<removed>",
+			pszOutput ? pszOutput : "?",
+			pEntry->fires,
+			pEntry->actions,
+			pEntry->nanoseconds / 1e6,
+			pEntry->fires ? pEntry->nanoseconds / 1e3 / pEntry->fires : 0.0);
+	}
+}
+
+static bool ReadRanked(IPluginContext *pContext, cell_t rank, const OutputProfiler::Entry **ppEntry)
+{
+	*ppEntry = rank >= 0 ? g_OutputProfiler.GetRanked(rank) : nullptr;
+	if (!*ppEntry)
+	{
+		pContext->ThrowNativeError("Invalid rank %d, call GetOutputProfileCount first", rank);
+		return false;
+	}
+
+	return true;
+}
+
+cell_t SetOutputProfilerEnabled(IPluginContext *pContext, const cell_t *params)
+{
+	if (!g_OutputProfiler.SetEnabled(params[1] != 0))
+	{
+		return pContext->ThrowNativeError("FireOutput hooks are unavailable, check the error log");
+	}
+
+	return 1;
+}
+
+cell_t IsOutputProfilerEnabled(IPluginContext *pContext, const cell_t *params)
+{
+	return g_OutputProfiler.IsEnabled();
+}
+
+cell_t ResetOutputProfiler(IPluginContext *pContext, const cell_t *params)
+{
+	g_OutputProfiler.Reset();
+	return 1;
+}
+
+cell_t GetOutputProfileCount(IPluginContext *pContext, const cell_t *params)
+{
+	return g_OutputProfiler.Rank();
+}
+
+cell_t GetOutputProfileEntry(IPluginContext *pContext, const cell_t *params)
+{
+	const OutputProfiler::Entry *pEntry;
+	if (!ReadRanked(pContext, params[1], &pEntry))
+		return 0;
+
+	cell_t *pEntityAddr, *pFires, *pActions, *pTime;
+	pContext->LocalToPhysAddr(params[2], &pEntityAddr);
+	pContext->LocalToPhysAddr(params[5], &pFires);
+	pContext->LocalToPhysAddr(params[6], &pActions);
+	pContext->LocalToPhysAddr(params[7], &pTime);
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(pEntry->entref);
+	const char *pszOutput = pEntity ? GetOutputName(pEntity, pEntry->pOutput) : nullptr;
+
+	*pEntityAddr = pEntity ? gamehelpers->EntityToBCompatRef(pEntity) : -1;
+	*pFires = pEntry->fires;
+	*pActions = pEntry->actions;
+	*pTime = sp_ftoc((float)(pEntry->nanoseconds / 1e9));
+	pContext->StringToLocal(params[3], params[4], pszOutput ? pszOutput : "");
+
+	return 1;
+}
+
+const sp_nativeinfo_t g_ProfilerNatives[] =
+{
+	{ "SetOutputProfilerEnabled",	SetOutputProfilerEnabled },
+	{ "IsOutputProfilerEnabled",	IsOutputProfilerEnabled },
+	{ "ResetOutputProfiler",		ResetOutputProfiler },
+	{ "GetOutputProfileCount",		GetOutputProfileCount },
+	{ "GetOutputProfileEntry",		GetOutputProfileEntry },
+	{ NULL, NULL },
+};
@@ -0,0 +1,107 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_PROFILER_H_
+#define _INCLUDE_OUTPUTINFO_PROFILER_H_
+
+/**
+ * @file profiler.h
+ * @brief Per-output fire counters and timings, collected from the FireOutput detour.
+ */
+
+#include "extension.h"
+#include <chrono>
+#include <stdint.h>
+#include <vector>
+
+class CBaseEntityOutput;
+
+/**
+ * Counters live in a fixed open-addressed table keyed by the output's address
+ * and its entity's reference, so recording a fire never allocates. Once the
+ * table is three quarters full new outputs are counted as dropped. Times are
+ * inclusive of anything fired synchronously by the output's actions.
+ */
+class OutputProfiler
+{
+public:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	struct Entry
+	{
+		CBaseEntityOutput *pOutput;
+		cell_t entref;
+		unsigned int fires;
+		unsigned int actions;
+		uint64_t nanoseconds;
+	};
+
+	OutputProfiler();
+
+	bool IsEnabled() { return m_bEnabled; }
+
+	/**
+	 * @return				False if the FireOutput detour is unavailable.
+	 */
+	bool SetEnabled(bool enable);
+	void Reset();
+
+	/**
+	 * @brief Returns the counters to record a fire into, or nullptr if the table is full.
+	 */
+	Entry *Find(CBaseEntityOutput *pOutput, CBaseEntity *pCaller);
+
+	/**
+	 * @brief Ranks the recorded outputs by cumulative time, most expensive first.
+	 *
+	 * @return				Number of ranked outputs.
+	 */
+	size_t Rank();
+	const Entry *GetRanked(size_t rank);
+
+	void Print(size_t count);
+
+public:
+	unsigned int m_Dropped;
+
+private:
+	static const size_t kCapacity = 4096;
+
+	Entry m_Table[kCapacity];
+	size_t m_Used;
+	std::vector<const Entry *> m_Ranking;
+	bool m_bEnabled;
+};
+
+extern OutputProfiler g_OutputProfiler;
+extern const sp_nativeinfo_t g_ProfilerNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_PROFILER_H_
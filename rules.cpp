@@ -0,0 +1,572 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "rules.h"
+#include "entityoutput.h"
+#include "stringpool.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file rules.cpp
+ * @brief Output rewrite rules from config files, applied as entities spawn.
+ *
+ * See configs/outputinfo/global.cfg for the file format. Operations run in
+ * file order; an operation's "output" defaults to the one in "match".
+ */
+
+OutputRules g_OutputRules;
+ISDKHooks *g_pSDKHooks = nullptr;
+
+static void OnGameFrame(bool simulating)
+{
+	g_OutputRules.ProcessQueue();
+}
+
+OutputRules::OutputRules() :
+	m_Applied(0),
+	m_NumRules(0),
+	m_bCompiled(false),
+	m_pParsing(nullptr),
+	m_pOp(nullptr),
+	m_Depth(0),
+	m_bInMatch(false)
+{
+}
+
+void OutputRules::Init()
+{
+	smutils->AddGameFrameHook(OnGameFrame);
+
+	SM_GET_LATE_IFACE(SDKHOOKS, g_pSDKHooks);
+	if (g_pSDKHooks)
+		g_pSDKHooks->AddEntityListener(this);
+	else
+		smutils->LogError(myself, "SDKHooks is unavailable, output rules only apply to entities present at map start");
+}
+
+void OutputRules::Shutdown()
+{
+	smutils->RemoveGameFrameHook(OnGameFrame);
+
+	if (g_pSDKHooks)
+	{
+		g_pSDKHooks->RemoveEntityListener(this);
+		g_pSDKHooks = nullptr;
+	}
+}
+
+const OutputRules::ParsedFile *OutputRules::LoadFile(const char *pszPath)
+{
+	time_t mtime;
+	if (!libsys->FileTime(pszPath, FileTime_LastChange, &mtime))
+		return nullptr;
+
+	std::unique_ptr<ParsedFile> &pFile = m_Files[pszPath];
+	if (pFile && pFile->mtime == mtime)
+		return pFile.get();
+
+	pFile.reset(new ParsedFile);
+	pFile->mtime = mtime;
+
+	m_pParsing = pFile.get();
+
+	SMCStates states = {0, 0};
+	SMCError err = textparsers->ParseSMCFile(pszPath, this, &states, NULL, 0);
+	if (err != SMCError_Okay)
+	{
+		const char *pszError = textparsers->GetSMCErrorString(err);
+		smutils->LogError(myself, "Could not parse output rules \"%s\" (line %d): %s", pszPath, states.line, pszError ? pszError : "Unknown error");
+		pFile->rules.clear();
+	}
+
+	m_pParsing = nullptr;
+	return pFile.get();
+}
+
+void OutputRules::ReadSMC_ParseStart()
+{
+	m_pOp = nullptr;
+	m_Depth = 0;
+	m_bInMatch = false;
+}
+
+SMCResult OutputRules::ReadSMC_NewSection(const SMCStates *states, const char *name)
+{
+	m_Depth++;
+
+	if (m_Depth == 2)
+	{
+		m_pParsing->rules.emplace_back();
+	}
+	else if (m_Depth == 3)
+	{
+		ParsedRule &rule = m_pParsing->rules.back();
+
+		if (strcmp(name, "match") == 0)
+		{
+			m_bInMatch = true;
+			return SMCResult_Continue;
+		}
+
+		OpType type;
+		if (strcmp(name, "remove") == 0)
+			type = Op_Remove;
+		else if (strcmp(name, "add") == 0)
+			type = Op_Add;
+		else if (strcmp(name, "modify") == 0)
+			type = Op_Modify;
+		else
+		{
+			smutils->LogError(myself, "Unknown output rule section \"%s\" (line %d)", name, states->line);
+			return SMCResult_HaltFail;
+		}
+
+		rule.ops.emplace_back();
+		m_pOp = &rule.ops.back();
+		m_pOp->type = type;
+		m_pOp->delay = 0.0f;
+		m_pOp->timesToFire = EVENT_FIRE_ALWAYS;
+		m_pOp->flags = 0;
+	}
+	else if (m_Depth > 3)
+	{
+		smutils->LogError(myself, "Output rules nest too deep (line %d)", states->line);
+		return SMCResult_HaltFail;
+	}
+
+	return SMCResult_Continue;
+}
+
+// As the game's own action parser: 0 means the action never runs out
+static int ParseTimesToFire(const char *value)
+{
+	int timesToFire = atoi(value);
+	return timesToFire == 0 ? EVENT_FIRE_ALWAYS : timesToFire;
+}
+
+SMCResult OutputRules::ReadSMC_KeyValue(const SMCStates *states, const char *key, const char *value)
+{
+	if (m_Depth != 3)
+		return SMCResult_Continue;
+
+	if (m_bInMatch)
+	{
+		ParsedRule &rule = m_pParsing->rules.back();
+		if (strcmp(key, "classname") == 0)
+			rule.classname = value;
+		else if (strcmp(key, "targetname") == 0)
+			rule.targetname = value;
+		else if (strcmp(key, "output") == 0)
+			rule.output = value;
+		return SMCResult_Continue;
+	}
+
+	if (!m_pOp)
+		return SMCResult_Continue;
+
+	if (strcmp(key, "output") == 0)
+		m_pOp->output = value;
+	else if (strcmp(key, "target") == 0)
+		m_pOp->target = value;
+	else if (strcmp(key, "input") == 0)
+		m_pOp->targetInput = value;
+	else if (strcmp(key, "parameter") == 0)
+		m_pOp->parameter = value;
+	else if (strcmp(key, "delay") == 0)
+		m_pOp->delay = (float)atof(value);
+	else if (strcmp(key, "timestofire") == 0)
+		m_pOp->timesToFire = ParseTimesToFire(value);
+	else if (strcmp(key, "newtarget") == 0)
+	{
+		m_pOp->newTarget = value;
+		m_pOp->flags |= Modify_Target;
+	}
+	else if (strcmp(key, "newinput") == 0)
+	{
+		m_pOp->newTargetInput = value;
+		m_pOp->flags |= Modify_TargetInput;
+	}
+	else if (strcmp(key, "newparameter") == 0)
+	{
+		m_pOp->newParameter = value;
+		m_pOp->flags |= Modify_Parameter;
+	}
+	else if (strcmp(key, "newdelay") == 0)
+	{
+		m_pOp->delay = (float)atof(value);
+		m_pOp->flags |= Modify_Delay;
+	}
+	else if (strcmp(key, "newtimestofire") == 0)
+	{
+		// 0 is kept: it removes the action, as SetOutputActionTimesToFire does
+		m_pOp->timesToFire = atoi(value);
+		m_pOp->flags |= Modify_TimesToFire;
+	}
+	else if (strcmp(key, "action") == 0)
+	{
+		// Same layout as the map: target,input,parameter,delay,timestofire
+		std::string fields[5];
+		int field = 0;
+		for (const char *p = value; *p && field < 5; p++)
+		{
+			if (*p == ',' || *p == '\x1b')
+				field++;
+			else
+				fields[field] += *p;
+		}
+
+		m_pOp->target = fields[0];
+		m_pOp->targetInput = fields[1];
+		m_pOp->parameter = fields[2];
+		m_pOp->delay = fields[3].empty() ? 0.0f : (float)atof(fields[3].c_str());
+		m_pOp->timesToFire = ParseTimesToFire(fields[4].c_str());
+	}
+
+	return SMCResult_Continue;
+}
+
+SMCResult OutputRules::ReadSMC_LeavingSection(const SMCStates *states)
+{
+	if (m_Depth == 3)
+	{
+		m_bInMatch = false;
+		m_pOp = nullptr;
+	}
+
+	m_Depth--;
+	return SMCResult_Continue;
+}
+
+static string_t InternFilter(const std::string &value)
+{
+	return value.empty() ? NULL_STRING : AllocPooledString(value.c_str());
+}
+
+void OutputRules::Compile(const ParsedFile *pFile)
+{
+	if (!pFile)
+		return;
+
+	for (size_t i = 0; i < pFile->rules.size(); i++)
+	{
+		const ParsedRule &parsed = pFile->rules[i];
+
+		CompiledRule rule;
+		rule.targetname = InternFilter(parsed.targetname);
+
+		for (size_t j = 0; j < parsed.ops.size(); j++)
+		{
+			const ParsedOp &parsedOp = parsed.ops[j];
+
+			CompiledOp op;
+			op.type = parsedOp.type;
+			op.output = parsedOp.output.empty() ? parsed.output.c_str() : parsedOp.output.c_str();
+			op.target = InternFilter(parsedOp.target);
+			op.targetInput = InternFilter(parsedOp.targetInput);
+			op.parameter = InternFilter(parsedOp.parameter);
+			op.newTarget = InternFilter(parsedOp.newTarget);
+			op.newTargetInput = InternFilter(parsedOp.newTargetInput);
+			op.newParameter = InternFilter(parsedOp.newParameter);
+			op.delay = parsedOp.delay;
+			op.timesToFire = parsedOp.timesToFire;
+			op.flags = parsedOp.flags;
+
+			if (!op.output[0])
+			{
+				smutils->LogError(myself, "Output rule operation without an output, skipping");
+				continue;
+			}
+
+			rule.ops.push_back(op);
+		}
+
+		if (rule.ops.empty())
+			continue;
+
+		Bucket *pBucket = &m_AnyClass;
+		if (!parsed.classname.empty() && !m_Buckets.retrieve(parsed.classname.c_str(), &pBucket))
+		{
+			pBucket = new Bucket;
+			m_BucketStorage.emplace_back(pBucket);
+			m_Buckets.insert(parsed.classname.c_str(), pBucket);
+		}
+
+		pBucket->push_back(rule);
+		m_NumRules++;
+	}
+}
+
+void OutputRules::LoadRules()
+{
+	char path[PLATFORM_MAX_PATH];
+	smutils->BuildPath(Path_SM, path, sizeof(path), "configs/outputinfo/global.cfg");
+	Compile(LoadFile(path));
+
+	smutils->BuildPath(Path_SM, path, sizeof(path), "configs/outputinfo/maps/%s.cfg", gamehelpers->GetCurrentMap());
+	Compile(LoadFile(path));
+
+	m_bCompiled = true;
+}
+
+void OutputRules::OnLevelStart()
+{
+	OnLevelEnd();
+	LoadRules();
+
+	if (m_NumRules == 0)
+		return;
+
+	for (CBaseEntity *pEntity = NextEntity(nullptr); pEntity != nullptr; pEntity = NextEntity(pEntity))
+		Apply(pEntity, gamehelpers->GetEntityClassname(pEntity));
+}
+
+void OutputRules::OnLevelEnd()
+{
+	m_Buckets.clear();
+	m_BucketStorage.clear();
+	m_AnyClass.clear();
+	m_NumRules = 0;
+	m_Queue.clear();
+	m_bCompiled = false;
+}
+
+void OutputRules::Reload()
+{
+	m_Files.clear();
+
+	if (m_bCompiled)
+	{
+		OnLevelEnd();
+		LoadRules();
+	}
+}
+
+void OutputRules::OnEntityCreated(CBaseEntity *pEntity, const char *classname)
+{
+	if (!m_bCompiled || m_NumRules == 0)
+		return;
+
+	Bucket *pBucket;
+	if (m_AnyClass.empty() && (!classname || !m_Buckets.retrieve(classname, &pBucket)))
+		return;
+
+	// Keyvalues and outputs aren't set up until after this returns
+	m_Queue.push_back(gamehelpers->EntityToReference(pEntity));
+}
+
+void OutputRules::ProcessQueue()
+{
+	if (m_Queue.empty())
+		return;
+
+	for (size_t i = 0; i < m_Queue.size(); i++)
+	{
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(m_Queue[i]);
+		if (pEntity)
+			Apply(pEntity, gamehelpers->GetEntityClassname(pEntity));
+	}
+
+	m_Queue.clear();
+}
+
+int OutputRules::Apply(CBaseEntity *pEntity, const char *pszClassname)
+{
+	int applied = 0;
+
+	Bucket *pBucket;
+	if (pszClassname && m_Buckets.retrieve(pszClassname, &pBucket))
+	{
+		for (size_t i = 0; i < pBucket->size(); i++)
+			applied += ApplyRule(pEntity, (*pBucket)[i]);
+	}
+
+	for (size_t i = 0; i < m_AnyClass.size(); i++)
+		applied += ApplyRule(pEntity, m_AnyClass[i]);
+
+	m_Applied += applied;
+	return applied;
+}
+
+static bool StringMatches(string_t value, string_t filter)
+{
+	return value == filter || stricmp(value.ToCStr(), filter.ToCStr()) == 0;
+}
+
+int OutputRules::ApplyRule(CBaseEntity *pEntity, const CompiledRule &rule)
+{
+	if (rule.targetname != NULL_STRING)
+	{
+		static int s_NameOffset = -1;
+		if (s_NameOffset == -1)
+		{
+			sm_datatable_info_t info;
+			if (!gamehelpers->FindDataMapInfo(gamehelpers->GetDataMap(pEntity), "m_iName", &info))
+				return 0;
+
+			s_NameOffset = info.actual_offset;
+		}
+
+		string_t name = *(string_t *)((intptr_t)pEntity + s_NameOffset);
+		if (!StringMatches(name, rule.targetname))
+			return 0;
+	}
+
+	int applied = 0;
+	for (size_t i = 0; i < rule.ops.size(); i++)
+	{
+		CBaseEntityOutput *pOutput = FindOutput(pEntity, rule.ops[i].output);
+		if (pOutput)
+			applied += ApplyOp(pEntity, pOutput, rule.ops[i]);
+	}
+
+	return applied;
+}
+
+CBaseEntityOutput *OutputRules::FindOutput(CBaseEntity *pEntity, const char *pszName)
+{
+	const OutputField *pField = FindOutputField(pEntity, pszName);
+	if (!pField)
+		return nullptr;
+
+	return (CBaseEntityOutput *)((intptr_t)pEntity + pField->offset);
+}
+
+bool OutputRules::Matches(CEventAction *pAction, const CompiledOp &op)
+{
+	if (op.target != NULL_STRING && !StringMatches(pAction->m_iTarget, op.target))
+		return false;
+	if (op.targetInput != NULL_STRING && !StringMatches(pAction->m_iTargetInput, op.targetInput))
+		return false;
+	if (op.parameter != NULL_STRING && !StringMatches(pAction->m_iParameter, op.parameter))
+		return false;
+
+	return true;
+}
+
+int OutputRules::ApplyOp(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, const CompiledOp &op)
+{
+	int applied = 0;
+
+	switch (op.type)
+	{
+	case Op_Remove:
+		for (CEventAction **ppLink = &pOutput->m_ActionList; *ppLink != NULL; )
+		{
+			CEventAction *pAction = *ppLink;
+			if (!Matches(pAction, op))
+			{
+				ppLink = &pAction->m_pNext;
+				continue;
+			}
+
+			*ppLink = pAction->m_pNext;
+			delete pAction;
+			applied++;
+		}
+
+		if (applied)
+			OnOutputListChanged(pOutput);
+		break;
+
+	case Op_Add:
+	{
+		CEventAction *pAction = new CEventAction(NULL);
+		pAction->m_iTarget = op.target;
+		pAction->m_iTargetInput = op.targetInput;
+		pAction->m_iParameter = op.parameter;
+		pAction->m_flDelay = op.delay;
+		pAction->m_nTimesToFire = op.timesToFire;
+		pAction->m_pNext = NULL;
+
+		CEventAction **ppLink = &pOutput->m_ActionList;
+		while (*ppLink != NULL)
+			ppLink = &(*ppLink)->m_pNext;
+		*ppLink = pAction;
+
+		OnOutputListChanged(pOutput);
+		OnOutputActionChanged(pEntity, pOutput, pAction);
+		applied++;
+		break;
+	}
+
+	case Op_Modify:
+	{
+		bool removed = false;
+		for (CEventAction **ppLink = &pOutput->m_ActionList; *ppLink != NULL; )
+		{
+			CEventAction *pAction = *ppLink;
+			if (!Matches(pAction, op))
+			{
+				ppLink = &pAction->m_pNext;
+				continue;
+			}
+
+			// Firing zero more times means the action is gone
+			if ((op.flags & Modify_TimesToFire) && op.timesToFire == 0)
+			{
+				*ppLink = pAction->m_pNext;
+				delete pAction;
+				removed = true;
+				applied++;
+				continue;
+			}
+
+			ppLink = &pAction->m_pNext;
+
+			if (op.flags & Modify_TargetInput)
+				pAction->m_iTargetInput = op.newTargetInput;
+			if (op.flags & Modify_Parameter)
+				pAction->m_iParameter = op.newParameter;
+			if (op.flags & Modify_Delay)
+				pAction->m_flDelay = op.delay;
+			if (op.flags & Modify_TimesToFire)
+				pAction->m_nTimesToFire = op.timesToFire;
+			if (op.flags & Modify_Target)
+			{
+				pAction->m_iTarget = op.newTarget;
+				OnOutputActionChanged(pEntity, pOutput, pAction);
+			}
+
+			applied++;
+		}
+
+		if (removed)
+			OnOutputListChanged(pOutput);
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	return applied;
+}
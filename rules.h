@@ -0,0 +1,193 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_RULES_H_
+#define _INCLUDE_OUTPUTINFO_RULES_H_
+
+/**
+ * @file rules.h
+ * @brief Output rewrite rules from config files, applied as entities spawn.
+ */
+
+#include "extension.h"
+#include <ISDKHooks.h>
+#include <ITextParsers.h>
+#include <sm_stringhashmap.h>
+#include <string_t.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CBaseEntityOutput;
+
+/**
+ * Rules are read from configs/outputinfo/global.cfg and
+ * configs/outputinfo/maps/<map>.cfg. Parsed files are cached by path and
+ * modification time, so rounds and map revisits don't re-parse them. On map
+ * start the rules are compiled into buckets keyed by classname, with every
+ * string interned once, and applied to all entities. Entities created later
+ * are queued from the SDKHooks entity listener and rewritten on the next frame,
+ * after their keyvalues and outputs are set up.
+ */
+class OutputRules :
+	public ISMEntityListener,
+	public ITextListener_SMC
+{
+public:
+	OutputRules();
+
+	void Init();
+	void Shutdown();
+
+	/**
+	 * @brief Loads and compiles the rules for the current map and applies them
+	 * to every existing entity.
+	 */
+	void OnLevelStart();
+	void OnLevelEnd();
+
+	/**
+	 * @brief Drops the parsed file cache and recompiles. Only future spawns are affected.
+	 */
+	void Reload();
+
+	/**
+	 * @return				Number of rule operations applied to the entity.
+	 */
+	int Apply(CBaseEntity *pEntity, const char *pszClassname);
+
+	void ProcessQueue();
+
+	size_t NumRules() { return m_NumRules; }
+	size_t NumFiles() { return m_Files.size(); }
+	unsigned int m_Applied;
+
+public: // ISMEntityListener
+	void OnEntityCreated(CBaseEntity *pEntity, const char *classname);
+
+public: // ITextListener_SMC
+	void ReadSMC_ParseStart();
+	SMCResult ReadSMC_NewSection(const SMCStates *states, const char *name);
+	SMCResult ReadSMC_KeyValue(const SMCStates *states, const char *key, const char *value);
+	SMCResult ReadSMC_LeavingSection(const SMCStates *states);
+
+private:
+	enum OpType
+	{
+		Op_Remove,
+		Op_Add,
+		Op_Modify,
+	};
+
+	enum ModifyFlags
+	{
+		Modify_Target = (1<<0),
+		Modify_TargetInput = (1<<1),
+		Modify_Parameter = (1<<2),
+		Modify_Delay = (1<<3),
+		Modify_TimesToFire = (1<<4),
+	};
+
+	struct ParsedOp
+	{
+		OpType type;
+		std::string output;
+		std::string target, targetInput, parameter;			// filters, or the new action for Op_Add
+		std::string newTarget, newTargetInput, newParameter;
+		float delay;
+		int timesToFire;
+		int flags;
+	};
+
+	struct ParsedRule
+	{
+		std::string classname;
+		std::string targetname;
+		std::string output;
+		std::vector<ParsedOp> ops;
+	};
+
+	struct ParsedFile
+	{
+		time_t mtime;
+		std::vector<ParsedRule> rules;
+	};
+
+	struct CompiledOp
+	{
+		OpType type;
+		const char *output;
+		string_t target, targetInput, parameter;
+		string_t newTarget, newTargetInput, newParameter;
+		float delay;
+		int timesToFire;
+		int flags;
+	};
+
+	struct CompiledRule
+	{
+		string_t targetname;
+		std::vector<CompiledOp> ops;
+	};
+
+	typedef std::vector<CompiledRule> Bucket;
+
+	void LoadRules();
+	const ParsedFile *LoadFile(const char *pszPath);
+	void Compile(const ParsedFile *pFile);
+	int ApplyRule(CBaseEntity *pEntity, const CompiledRule &rule);
+	int ApplyOp(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, const CompiledOp &op);
+	bool Matches(CEventAction *pAction, const CompiledOp &op);
+	CBaseEntityOutput *FindOutput(CBaseEntity *pEntity, const char *pszName);
+
+private:
+	std::unordered_map<std::string, std::unique_ptr<ParsedFile>> m_Files;
+
+	StringHashMap<Bucket *> m_Buckets;
+	std::vector<std::unique_ptr<Bucket>> m_BucketStorage;
+	Bucket m_AnyClass;
+	size_t m_NumRules;
+	bool m_bCompiled;
+
+	std::vector<cell_t> m_Queue;
+
+	// Parser state
+	ParsedFile *m_pParsing;
+	ParsedOp *m_pOp;
+	int m_Depth;
+	bool m_bInMatch;
+};
+
+extern OutputRules g_OutputRules;
+extern ISDKHooks *g_pSDKHooks;
+
+#endif // _INCLUDE_OUTPUTINFO_RULES_H_
@@ -0,0 +1,206 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "snapshot.h"
+#include "actionrefs.h"
+#include "entityoutput.h"
+
+/**
+ * @file snapshot.cpp
+ * @brief Map-wide snapshot of every output's actions, for resetting rounds.
+ */
+
+OutputSnapshot g_OutputSnapshot;
+
+int OutputSnapshot::Capture()
+{
+	Clear();
+
+	for (CBaseEntity *pEntity = NextEntity(nullptr); pEntity != nullptr; pEntity = NextEntity(pEntity))
+	{
+		const std::vector<OutputField> *pFields = GetOutputFields(pEntity);
+		if (!pFields)
+			continue;
+
+		cell_t entref = gamehelpers->EntityToReference(pEntity);
+		for (size_t i = 0; i < pFields->size(); i++)
+		{
+			SavedOutput saved;
+			saved.entref = entref;
+			saved.pOutput = (CBaseEntityOutput *)((intptr_t)pEntity + (*pFields)[i].offset);
+			saved.first = (int)m_Actions.size();
+			saved.count = 0;
+
+			for (CEventAction *pAction = saved.pOutput->m_ActionList; pAction != NULL; pAction = pAction->m_pNext)
+			{
+				SavedAction action;
+				action.target = pAction->m_iTarget;
+				action.targetInput = pAction->m_iTargetInput;
+				action.parameter = pAction->m_iParameter;
+				action.delay = pAction->m_flDelay;
+				action.timesToFire = pAction->m_nTimesToFire;
+				m_Actions.push_back(action);
+				saved.count++;
+			}
+
+			m_Outputs.push_back(saved);
+		}
+	}
+
+	return (int)m_Actions.size();
+}
+
+bool OutputSnapshot::Matches(CBaseEntityOutput *pOutput, const SavedAction *pSaved, int count)
+{
+	CEventAction *pAction = pOutput->m_ActionList;
+	for (int i = 0; i < count; i++, pAction = pAction->m_pNext)
+	{
+		if (pAction == NULL)
+			return false;
+
+		if (pAction->m_iTarget != pSaved[i].target || pAction->m_iTargetInput != pSaved[i].targetInput
+			|| pAction->m_iParameter != pSaved[i].parameter || pAction->m_flDelay != pSaved[i].delay
+			|| pAction->m_nTimesToFire != pSaved[i].timesToFire)
+		{
+			return false;
+		}
+	}
+
+	return pAction == NULL;
+}
+
+bool OutputSnapshot::RestoreOutput(CBaseEntity *pEntity, const SavedOutput &saved)
+{
+	CBaseEntityOutput *pOutput = saved.pOutput;
+	const SavedAction *pSaved = saved.count ? &m_Actions[saved.first] : nullptr;
+
+	bool modified = false;
+	CEventAction **ppLink = &pOutput->m_ActionList;
+
+	for (int i = 0; i < saved.count; i++, ppLink = &(*ppLink)->m_pNext)
+	{
+		CEventAction *pAction = *ppLink;
+		bool created = false;
+		if (pAction == NULL)
+		{
+			pAction = new CEventAction(NULL);
+			pAction->m_pNext = NULL;
+			*ppLink = pAction;
+			created = modified = true;
+		}
+
+		bool changed = created || pAction->m_iTarget != pSaved[i].target || pAction->m_iTargetInput != pSaved[i].targetInput
+			|| pAction->m_iParameter != pSaved[i].parameter || pAction->m_flDelay != pSaved[i].delay
+			|| pAction->m_nTimesToFire != pSaved[i].timesToFire;
+
+		if (!changed)
+			continue;
+
+		// A reused node is a different action now; refs and iterators holding its stamp must see that
+		if (!created)
+		{
+			g_ActionRefs.OnActionFreed(pAction);
+			pAction->m_iIDStamp = ++CEventAction::s_iNextIDStamp;
+		}
+
+		pAction->m_iTarget = pSaved[i].target;
+		pAction->m_iTargetInput = pSaved[i].targetInput;
+		pAction->m_iParameter = pSaved[i].parameter;
+		pAction->m_flDelay = pSaved[i].delay;
+		pAction->m_nTimesToFire = pSaved[i].timesToFire;
+
+		OnOutputActionChanged(pEntity, pOutput, pAction);
+		modified = true;
+	}
+
+	CEventAction *pExtra = *ppLink;
+	if (pExtra != NULL)
+	{
+		*ppLink = NULL;
+		while (pExtra != NULL)
+		{
+			CEventAction *pNext = pExtra->m_pNext;
+			delete pExtra;
+			pExtra = pNext;
+		}
+		modified = true;
+	}
+
+	if (modified)
+		OnOutputListChanged(pOutput);
+
+	return true;
+}
+
+int OutputSnapshot::Restore(bool changedOnly)
+{
+	int restored = 0;
+
+	for (size_t i = 0; i < m_Outputs.size(); i++)
+	{
+		const SavedOutput &saved = m_Outputs[i];
+
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(saved.entref);
+		if (!pEntity)
+			continue;
+
+		if (changedOnly && Matches(saved.pOutput, saved.count ? &m_Actions[saved.first] : nullptr, saved.count))
+			continue;
+
+		if (RestoreOutput(pEntity, saved))
+			restored++;
+	}
+
+	return restored;
+}
+
+void OutputSnapshot::Clear()
+{
+	m_Outputs.clear();
+	m_Actions.clear();
+}
+
+cell_t CaptureOutputSnapshot(IPluginContext *pContext, const cell_t *params)
+{
+	return g_OutputSnapshot.Capture();
+}
+
+cell_t RestoreOutputSnapshot(IPluginContext *pContext, const cell_t *params)
+{
+	return g_OutputSnapshot.Restore(params[1] != 0);
+}
+
+const sp_nativeinfo_t g_SnapshotNatives[] =
+{
+	{ "CaptureOutputSnapshot",	CaptureOutputSnapshot },
+	{ "RestoreOutputSnapshot",	RestoreOutputSnapshot },
+	{ NULL, NULL },
+};
@@ -0,0 +1,103 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_SNAPSHOT_H_
+#define _INCLUDE_OUTPUTINFO_SNAPSHOT_H_
+
+/**
+ * @file snapshot.h
+ * @brief Map-wide snapshot of every output's actions, for resetting rounds.
+ */
+
+#include "extension.h"
+#include <string_t.h>
+#include <vector>
+
+class CBaseEntityOutput;
+
+/**
+ * Every output field of every entity is recorded as a range into one flat
+ * array of actions. The strings are the game's own pooled string_t, so
+ * capturing and comparing never copies or compares string contents.
+ * Entities spawned after the capture are left alone by restores.
+ */
+class OutputSnapshot
+{
+public:
+	/**
+	 * @return				Number of actions captured.
+	 */
+	int Capture();
+
+	/**
+	 * @brief Rewrites every captured output back to its captured actions,
+	 * reusing the nodes already in each list.
+	 *
+	 * @param changedOnly	Skip outputs that still match the snapshot.
+	 * @return				Number of outputs rewritten.
+	 */
+	int Restore(bool changedOnly);
+
+	void Clear();
+
+	size_t NumOutputs() { return m_Outputs.size(); }
+	size_t NumActions() { return m_Actions.size(); }
+
+private:
+	struct SavedAction
+	{
+		string_t target;
+		string_t targetInput;
+		string_t parameter;
+		float delay;
+		int timesToFire;
+	};
+
+	struct SavedOutput
+	{
+		cell_t entref;
+		CBaseEntityOutput *pOutput;
+		int first;
+		int count;
+	};
+
+	bool Matches(CBaseEntityOutput *pOutput, const SavedAction *pSaved, int count);
+	bool RestoreOutput(CBaseEntity *pEntity, const SavedOutput &saved);
+
+private:
+	std::vector<SavedOutput> m_Outputs;
+	std::vector<SavedAction> m_Actions;
+};
+
+extern OutputSnapshot g_OutputSnapshot;
+extern const sp_nativeinfo_t g_SnapshotNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_SNAPSHOT_H_
@@ -0,0 +1,134 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "stringpool.h"
+#include <iserverunknown.h>
+#include <itoolentity.h>
+
+/**
+ * @file stringpool.cpp
+ * @brief Interning of strings into the game's string pool.
+ */
+
+extern IServerTools *servertools;
+
+OutputStringPool g_StringPool;
+
+OutputStringPool::OutputStringPool() :
+	m_Hits(0),
+	m_EngineAllocs(0),
+	m_pfnAllocPooledString(nullptr),
+	m_bLevelEnded(false)
+{
+}
+
+void OutputStringPool::Init(IGameConfig *pGameConf)
+{
+	if (!pGameConf->GetMemSig("AllocPooledString", reinterpret_cast<void **>(&m_pfnAllocPooledString)))
+		m_pfnAllocPooledString = nullptr;
+}
+
+string_t OutputStringPool::Intern(const char *pszValue)
+{
+	if (m_bLevelEnded)
+		return EngineAlloc(pszValue);
+
+	string_t result;
+	if (m_Strings.retrieve(pszValue, &result))
+	{
+		m_Hits++;
+		return result;
+	}
+
+	result = EngineAlloc(pszValue);
+	m_Strings.insert(pszValue, result);
+	return result;
+}
+
+bool OutputStringPool::Find(const char *pszValue, string_t *pResult)
+{
+	if (m_bLevelEnded)
+		return false;
+
+	return m_Strings.retrieve(pszValue, pResult);
+}
+
+void OutputStringPool::OnLevelStart()
+{
+	m_bLevelEnded = false;
+}
+
+void OutputStringPool::OnLevelEnd()
+{
+	m_Strings.clear();
+	m_bLevelEnded = true;
+}
+
+size_t OutputStringPool::Size()
+{
+	return m_Strings.elements();
+}
+
+string_t OutputStringPool::EngineAlloc(const char *pszValue)
+{
+	m_EngineAllocs++;
+
+	if (m_pfnAllocPooledString)
+		return m_pfnAllocPooledString(pszValue);
+
+	// This is admittedly a giant hack, but it's a relatively safe method for
+	// inserting a string into the game's string pool that isn't likely to break.
+	//
+	// We find the first valid ent (should always be worldspawn), save off it's
+	// current targetname string_t, set it to our string to insert via SetKeyValue,
+	// read back the new targetname value, restore the old value, and return the new one.
+
+	CBaseEntity *pEntity = reinterpret_cast<IServerUnknown *>(servertools->FirstEntity())->GetBaseEntity();
+	auto *pDataMap = gamehelpers->GetDataMap(pEntity);
+	assert(pDataMap);
+
+	static int offset = -1;
+	if (offset == -1)
+	{
+		sm_datatable_info_t info;
+		bool found = gamehelpers->FindDataMapInfo(pDataMap, "m_iName", &info);
+		assert(found);
+		offset = info.actual_offset;
+	}
+
+	string_t *pProp = (string_t *) ((intp) pEntity + offset);
+	string_t backup = *pProp;
+	servertools->SetKeyValue(pEntity, "targetname", pszValue);
+	string_t newString = *pProp;
+	*pProp = backup;
+
+	return newString;
+}
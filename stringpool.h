@@ -0,0 +1,106 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_STRINGPOOL_H_
+#define _INCLUDE_OUTPUTINFO_STRINGPOOL_H_
+
+/**
+ * @file stringpool.h
+ * @brief Interning of strings into the game's string pool.
+ */
+
+#include "extension.h"
+#include <string_t.h>
+#include <sm_stringhashmap.h>
+
+/**
+ * Maps string contents to the game's pooled string_t so repeated values only
+ * reach the engine once per map. The game frees its pool on level shutdown,
+ * so the map is flushed in OnCoreMapEnd and bypassed until the next map starts.
+ */
+class OutputStringPool
+{
+public:
+	OutputStringPool();
+
+	/**
+	 * @brief Resolves the game's AllocPooledString, if gamedata provides it.
+	 * Falls back to the targetname keyvalue method otherwise.
+	 */
+	void Init(IGameConfig *pGameConf);
+
+	string_t Intern(const char *pszValue);
+
+	/**
+	 * @brief Looks a string up without adding it to the game's pool.
+	 *
+	 * @return				True if the string was interned this level.
+	 */
+	bool Find(const char *pszValue, string_t *pResult);
+
+	void OnLevelStart();
+	void OnLevelEnd();
+
+	size_t Size();
+
+public:
+	unsigned int m_Hits;
+	unsigned int m_EngineAllocs;
+
+private:
+	string_t EngineAlloc(const char *pszValue);
+
+private:
+	typedef string_t (*AllocPooledStringFunc)(const char *pszValue);
+
+	StringHashMap<string_t> m_Strings;
+	AllocPooledStringFunc m_pfnAllocPooledString;
+	bool m_bLevelEnded;
+};
+
+/**
+ * @brief Opaque id of a pooled string for plugins to compare: the string's
+ * address, which the game's pool shares between equal strings for the level.
+ * The server is 32-bit, so it fits a cell.
+ */
+inline cell_t PooledStringId(string_t value)
+{
+	return value == NULL_STRING ? 0 : (cell_t)(intptr_t)value.ToCStr();
+}
+
+extern OutputStringPool g_StringPool;
+
+inline string_t AllocPooledString(const char *pszValue)
+{
+	return g_StringPool.Intern(pszValue);
+}
+
+#endif // _INCLUDE_OUTPUTINFO_STRINGPOOL_H_
@@ -0,0 +1,181 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "targetindex.h"
+#include "actionrefs.h"
+#include "outputgraph.h"
+#include <ctype.h>
+
+/**
+ * @file targetindex.cpp
+ * @brief Map-wide reverse index from action target names to the actions firing at them.
+ */
+
+OutputTargetIndex g_TargetIndex;
+
+void OnOutputActionChanged(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction)
+{
+	g_TargetIndex.AddAction(pEntity, pOutput, pAction);
+	g_OutputGraph.OnOutputChanged(pOutput);
+}
+
+void OutputTargetIndex::MakeKey(const char *pszTarget, char *buffer, size_t maxlength)
+{
+	size_t i = 0;
+	for (; i < maxlength - 1 && pszTarget[i] != '\0'; i++)
+		buffer[i] = tolower((unsigned char)pszTarget[i]);
+
+	buffer[i] = '\0';
+}
+
+OutputTargetIndex::Bucket *OutputTargetIndex::FindBucket(const char *pszTarget, bool create)
+{
+	char key[256];
+	MakeKey(pszTarget, key, sizeof(key));
+
+	Bucket *pBucket;
+	if (m_Buckets.retrieve(key, &pBucket))
+		return pBucket;
+
+	if (!create)
+		return nullptr;
+
+	pBucket = new Bucket;
+	m_BucketStorage.emplace_back(pBucket);
+	m_Buckets.insert(key, pBucket);
+	return pBucket;
+}
+
+bool OutputTargetIndex::IsLive(const Entry &entry, const char *pszTarget, CBaseEntity **ppEntity)
+{
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(entry.entref);
+	if (!pEntity)
+		return false;
+
+	CEventAction *pAction = entry.pAction;
+	if (pAction->m_iIDStamp != entry.stamp || pAction->m_nTimesToFire == 0)
+		return false;
+
+	if (stricmp(pAction->m_iTarget.ToCStr(), pszTarget) != 0)
+		return false;
+
+	*ppEntity = pEntity;
+	return true;
+}
+
+void OutputTargetIndex::AddAction(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction)
+{
+	if (!m_bBuilt)
+		return;
+
+	const char *pszTarget = pAction->m_iTarget.ToCStr();
+	if (pszTarget[0] == '\0')
+		return;
+
+	Bucket *pBucket = FindBucket(pszTarget, true);
+	for (size_t i = 0; i < pBucket->size(); i++)
+	{
+		if ((*pBucket)[i].pAction == pAction && (*pBucket)[i].stamp == pAction->m_iIDStamp)
+			return;
+	}
+
+	Entry entry;
+	entry.entref = gamehelpers->EntityToReference(pEntity);
+	entry.pOutput = pOutput;
+	entry.pAction = pAction;
+	entry.stamp = pAction->m_iIDStamp;
+	pBucket->push_back(entry);
+	m_Size++;
+}
+
+void OutputTargetIndex::Rebuild()
+{
+	Clear();
+	m_bBuilt = true;
+
+	for (CBaseEntity *pEntity = NextEntity(nullptr); pEntity != nullptr; pEntity = NextEntity(pEntity))
+	{
+		const std::vector<OutputField> *pFields = GetOutputFields(pEntity);
+		if (!pFields)
+			continue;
+
+		for (size_t i = 0; i < pFields->size(); i++)
+		{
+			CBaseEntityOutput *pOutput = (CBaseEntityOutput *)((intptr_t)pEntity + (*pFields)[i].offset);
+			for (CEventAction *pAction = pOutput->m_ActionList; pAction != NULL; pAction = pAction->m_pNext)
+				AddAction(pEntity, pOutput, pAction);
+		}
+	}
+}
+
+void OutputTargetIndex::Clear()
+{
+	m_Buckets.clear();
+	m_BucketStorage.clear();
+	m_Size = 0;
+	m_bBuilt = false;
+}
+
+cell_t FindOutputActionsByTarget(IPluginContext *pContext, const cell_t *params)
+{
+	char *pTarget, *pInput;
+	pContext->LocalToString(params[1], &pTarget);
+	pContext->LocalToString(params[4], &pInput);
+
+	cell_t *pActions;
+	pContext->LocalToPhysAddr(params[2], &pActions);
+
+	int maxactions = params[3];
+	int count = 0;
+
+	if (maxactions <= 0)
+		return 0;
+
+	g_TargetIndex.Query(pTarget, pInput, [&](CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction) {
+		pActions[count++] = g_ActionRefs.Register(pEntity, pOutput, pAction);
+		return count < maxactions;
+	});
+
+	return count;
+}
+
+cell_t RebuildOutputTargetIndex(IPluginContext *pContext, const cell_t *params)
+{
+	g_TargetIndex.Rebuild();
+	return g_TargetIndex.Size();
+}
+
+const sp_nativeinfo_t g_TargetIndexNatives[] =
+{
+	{ "FindOutputActionsByTarget",	FindOutputActionsByTarget },
+	{ "RebuildOutputTargetIndex",	RebuildOutputTargetIndex },
+	{ NULL, NULL },
+};
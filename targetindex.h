@@ -0,0 +1,144 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_TARGETINDEX_H_
+#define _INCLUDE_OUTPUTINFO_TARGETINDEX_H_
+
+/**
+ * @file targetindex.h
+ * @brief Map-wide reverse index from action target names to the actions firing at them.
+ */
+
+#include "extension.h"
+#include "entityoutput.h"
+#include <sm_stringhashmap.h>
+#include <memory>
+#include <vector>
+
+/**
+ * Built from every entity's outputs when the map starts and kept up to date
+ * by our own edit natives. Entries whose action was removed or retargeted
+ * since are dropped lazily when their bucket is queried.
+ *
+ * Buckets are keyed on the target alone, and a query's input is filtered
+ * within the bucket. Target inputs are rewritten by paths that don't report
+ * the owning entity (SetTargetInput on an action ref, the interface), so an
+ * action keyed on its input would silently go missing from queries once the
+ * input changed. The actions aimed at one name are few, so the filter is cheap.
+ */
+class OutputTargetIndex
+{
+public:
+	OutputTargetIndex() : m_Size(0), m_bBuilt(false) {}
+
+	void Rebuild();
+	void Clear();
+
+	void AddAction(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, CEventAction *pAction);
+
+	/**
+	 * @brief Calls back for every live action targeting a name.
+	 *
+	 * @param pszTarget		Target name, compared case-insensitively.
+	 * @param pszInput		Optional target input to filter on, or nullptr.
+	 * @param callback		Receives the owning entity, output and action;
+	 *						returns false to stop.
+	 * @return				Number of actions passed to callback.
+	 */
+	template <typename F>
+	int Query(const char *pszTarget, const char *pszInput, F callback);
+
+	size_t Size() { return m_Size; }
+
+private:
+	struct Entry
+	{
+		cell_t entref;
+		CBaseEntityOutput *pOutput;
+		CEventAction *pAction;
+		int stamp;
+	};
+
+	typedef std::vector<Entry> Bucket;
+
+	static void MakeKey(const char *pszTarget, char *buffer, size_t maxlength);
+
+	Bucket *FindBucket(const char *pszTarget, bool create = false);
+	bool IsLive(const Entry &entry, const char *pszTarget, CBaseEntity **ppEntity);
+
+private:
+	StringHashMap<Bucket *> m_Buckets;
+	std::vector<std::unique_ptr<Bucket>> m_BucketStorage;
+	size_t m_Size;
+	bool m_bBuilt;
+};
+
+template <typename F>
+int OutputTargetIndex::Query(const char *pszTarget, const char *pszInput, F callback)
+{
+	if (!m_bBuilt)
+		Rebuild();
+
+	Bucket *pBucket = FindBucket(pszTarget);
+	if (!pBucket)
+		return 0;
+
+	int found = 0;
+	for (size_t i = 0; i < pBucket->size(); )
+	{
+		Entry &entry = (*pBucket)[i];
+
+		CBaseEntity *pEntity;
+		if (!IsLive(entry, pszTarget, &pEntity))
+		{
+			entry = pBucket->back();
+			pBucket->pop_back();
+			m_Size--;
+			continue;
+		}
+
+		i++;
+
+		if (pszInput && pszInput[0] && stricmp(entry.pAction->m_iTargetInput.ToCStr(), pszInput) != 0)
+			continue;
+
+		found++;
+		if (!callback(pEntity, entry.pOutput, entry.pAction))
+			break;
+	}
+
+	return found;
+}
+
+extern OutputTargetIndex g_TargetIndex;
+extern const sp_nativeinfo_t g_TargetIndexNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_TARGETINDEX_H_
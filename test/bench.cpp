@@ -0,0 +1,211 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "harness.h"
+#include "stringpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench.cpp
+ * @brief Offline benchmark of the natives, through the same calls a plugin makes.
+ */
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+class BenchTimings
+{
+public:
+	BenchTimings(int samples)
+	{
+		m_Nanoseconds.reserve(samples);
+	}
+
+	void Add(BenchClock::duration elapsed)
+	{
+		m_Nanoseconds.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	}
+
+	void Print(const char *pszName)
+	{
+		if (m_Nanoseconds.empty())
+			return;
+
+		std::sort(m_Nanoseconds.begin(), m_Nanoseconds.end());
+
+		double total = 0.0;
+		for (size_t i = 0; i < m_Nanoseconds.size(); i++)
+			total += (double)m_Nanoseconds[i];
+
+		size_t count = m_Nanoseconds.size();
+		printf("  %-12s %10.0f ops/s   avg %9.0f ns   p50 %9lld ns   p99 %9lld ns\n",
+			pszName,
+			total > 0.0 ? count * 1e9 / total : 0.0,
+			total / count,
+			(long long)m_Nanoseconds[count / 2],
+			(long long)m_Nanoseconds[std::min(count - 1, count * 99 / 100)]);
+	}
+
+private:
+	std::vector<long long> m_Nanoseconds;
+};
+
+static const int kBenchActions = 64;
+
+static std::vector<std::string> MakeBenchStrings(const char *pszPrefix, int count)
+{
+	std::vector<std::string> strings;
+	strings.reserve(count);
+
+	char buffer[64];
+	for (int i = 0; i < count; i++)
+	{
+		snprintf(buffer, sizeof(buffer), "%s_%d", pszPrefix, i);
+		strings.push_back(buffer);
+	}
+
+	return strings;
+}
+
+static void TimeIntern(BenchTimings &timings, const std::vector<std::string> &strings, int samples)
+{
+	// Warm sets get one untimed pass, so their first sample is already known
+	if ((int)strings.size() < samples)
+	{
+		for (size_t i = 0; i < strings.size(); i++)
+			g_StringPool.Intern(strings[i].c_str());
+	}
+
+	for (int i = 0; i < samples; i++)
+	{
+		const char *pszValue = strings[i % strings.size()].c_str();
+
+		BenchClock::time_point start = BenchClock::now();
+		g_StringPool.Intern(pszValue);
+		timings.Add(BenchClock::now() - start);
+	}
+}
+
+/**
+ * Interning against the worldspawn SetKeyValue path it caches. Cold strings
+ * are new to the game, warm ones repeat a handful of names. The fake
+ * SetKeyValue is one hash set insert, far cheaper than the game's keyvalue
+ * dispatch, so the uncached rows are a lower bound.
+ */
+static void RunInternBenchmark(int samples)
+{
+	const int kWarmStrings = 16;
+
+	printf("Interning, %d samples each\n", samples);
+
+	BenchTimings keyValueCold(samples), keyValueWarm(samples), internCold(samples), internWarm(samples);
+
+	// Level end turns the cache off, leaving every call on SetKeyValue
+	g_StringPool.OnLevelEnd();
+	TimeIntern(keyValueCold, MakeBenchStrings("kv_cold", samples), samples);
+	TimeIntern(keyValueWarm, MakeBenchStrings("kv_warm", kWarmStrings), samples);
+	g_StringPool.OnLevelStart();
+
+	TimeIntern(internCold, MakeBenchStrings("intern_cold", samples), samples);
+	TimeIntern(internWarm, MakeBenchStrings("intern_warm", kWarmStrings), samples);
+
+	keyValueCold.Print("setkv cold");
+	keyValueWarm.Print("setkv warm");
+	internCold.Print("intern cold");
+	internWarm.Print("intern warm");
+}
+
+void RunBenchmarks(int samples)
+{
+	FakePluginContext ctx;
+	int relay = CreateFakeRelay("relay_bench");
+
+	// Locals live for the whole run, as a plugin's would across calls
+	cell_t output = ctx.String("m_OnTrigger");
+	cell_t target = ctx.String("bench_target");
+	cell_t input = ctx.String("Trigger");
+	cell_t param = ctx.String("");
+	cell_t buffer = ctx.Buffer(64);
+
+	SPVM_NATIVE_FUNC pfnCount = FindNative("GetOutputActionCount");
+	SPVM_NATIVE_FUNC pfnGetTarget = FindNative("GetOutputActionTarget");
+	SPVM_NATIVE_FUNC pfnSetTarget = FindNative("SetOutputActionTarget");
+	SPVM_NATIVE_FUNC pfnInsert = FindNative("InsertOutputAction");
+	SPVM_NATIVE_FUNC pfnRemove = FindNative("RemoveOutputAction");
+
+	for (int i = 0; i < kBenchActions; i++)
+	{
+		cell_t params[] = { 8, relay, output, target, input, param, sp_ftoc(0.0f), EVENT_FIRE_ALWAYS, i };
+		pfnInsert(ctx.Get(), params);
+	}
+
+	printf("Natives on a list of %d actions, %d samples each\n", kBenchActions, samples);
+
+	BenchTimings count(samples), get(samples), set(samples), insert(samples);
+	for (int i = 0; i < samples; i++)
+	{
+		int index = i % kBenchActions;
+
+		cell_t countParams[] = { 2, relay, output };
+		BenchClock::time_point start = BenchClock::now();
+		pfnCount(ctx.Get(), countParams);
+		count.Add(BenchClock::now() - start);
+
+		cell_t getParams[] = { 5, relay, output, index, buffer, 64 };
+		start = BenchClock::now();
+		pfnGetTarget(ctx.Get(), getParams);
+		get.Add(BenchClock::now() - start);
+
+		cell_t setParams[] = { 4, relay, output, index, target };
+		start = BenchClock::now();
+		pfnSetTarget(ctx.Get(), setParams);
+		set.Add(BenchClock::now() - start);
+
+		cell_t insertParams[] = { 8, relay, output, target, input, param, sp_ftoc(0.0f), EVENT_FIRE_ALWAYS, index };
+		cell_t removeParams[] = { 3, relay, output, index };
+		start = BenchClock::now();
+		pfnInsert(ctx.Get(), insertParams);
+		pfnRemove(ctx.Get(), removeParams);
+		insert.Add(BenchClock::now() - start);
+	}
+
+	count.Print("count");
+	get.Print("get");
+	set.Print("set");
+	insert.Print("insert+rm");
+
+	ClearFakeOutputs();
+
+	RunInternBenchmark(samples);
+}
@@ -0,0 +1,497 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "harness.h"
+#include "actionpool.h"
+#include "editqueue.h"
+#include "stringpool.h"
+#include <iserverunknown.h>
+#include <itoolentity.h>
+#include <stdarg.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @file fakes.cpp
+ * @brief Offline stand-ins for the game and SourceMod, for running natives without srcds.
+ *
+ * Entities are FakeEntity blocks described by hand-built datamaps. Actions
+ * come from a real CUtlMemoryPool set up like the game's
+ * CEventAction::s_Allocator, which the fake gamedata hands to the allocator.
+ */
+
+extern IServerTools *servertools;
+
+static std::vector<FakeEntity *> g_FakeEntities;
+static std::unordered_set<std::string> g_FakeStrings;	/**< The game's string pool */
+static unsigned int g_FakeKeyValueCalls = 0;
+
+static typedescription_t g_BaseFields[2];
+static typedescription_t g_RelayFields[3];
+static datamap_t g_BaseMap;
+static datamap_t g_RelayMap;
+
+static CUtlMemoryPool *g_pFakeActionPool = nullptr;
+
+static void **g_FakeGameHelpers = nullptr;
+static void **g_FakeServerTools = nullptr;
+static void **g_FakeGameConfig = nullptr;
+
+/**
+ * Datamaps
+ */
+
+static void DescribeField(typedescription_t &td, fieldtype_t type, const char *pszName, int offset, int flags, const char *pszExternalName)
+{
+	memset(&td, 0, sizeof(td));
+	td.fieldType = type;
+	td.fieldName = pszName;
+	TD_FIELD_OFFSET(&td) = offset;
+	td.fieldSize = 1;
+	td.flags = flags;
+	td.externalName = pszExternalName;
+}
+
+static void DescribeMap(datamap_t &map, typedescription_t *pFields, int count, const char *pszClassName, datamap_t *pBaseMap)
+{
+	memset(&map, 0, sizeof(map));
+	map.dataDesc = pFields;
+	map.dataNumFields = count;
+	map.dataClassName = pszClassName;
+	map.baseMap = pBaseMap;
+}
+
+static void DescribeDataMaps()
+{
+	// Flags as DEFINE_OUTPUT sets them
+	const int outputFlags = FTYPEDESC_OUTPUT | FTYPEDESC_SAVE | FTYPEDESC_KEY;
+
+	DescribeField(g_BaseFields[0], FIELD_STRING, "m_iName", offsetof(FakeEntity, m_iName), FTYPEDESC_SAVE | FTYPEDESC_KEY, "targetname");
+	DescribeField(g_BaseFields[1], FIELD_CUSTOM, "m_OnUser1", offsetof(FakeEntity, m_OnUser1), outputFlags, "OnUser1");
+	DescribeMap(g_BaseMap, g_BaseFields, 2, "CBaseEntity", NULL);
+
+	DescribeField(g_RelayFields[0], FIELD_BOOLEAN, "m_bDisabled", offsetof(FakeEntity, m_bDisabled), FTYPEDESC_SAVE | FTYPEDESC_KEY, "StartDisabled");
+	DescribeField(g_RelayFields[1], FIELD_CUSTOM, "m_OnTrigger", offsetof(FakeEntity, m_OnTrigger), outputFlags, "OnTrigger");
+	DescribeField(g_RelayFields[2], FIELD_CUSTOM, "m_OnSpawn", offsetof(FakeEntity, m_OnSpawn), outputFlags, "OnSpawn");
+	DescribeMap(g_RelayMap, g_RelayFields, 3, "CLogicRelay", &g_BaseMap);
+}
+
+/**
+ * Entities
+ */
+
+static CBaseEntity *Entity_GetBaseEntity(FakeEntity *pThis)
+{
+	return reinterpret_cast<CBaseEntity *>(pThis);
+}
+
+static FakeVTable<IServerUnknown> g_EntityVTable;
+
+static int AddFakeEntity(const char *pszClassname, datamap_t *pMap, const char *pszName)
+{
+	FakeEntity *pEntity = new FakeEntity();
+	pEntity->vptr = g_EntityVTable.Slots();
+	pEntity->index = (int)g_FakeEntities.size();
+	pEntity->classname = pszClassname;
+	pEntity->pMap = pMap;
+
+	if (pszName && pszName[0])
+	{
+		const std::string &pooled = *g_FakeStrings.insert(pszName).first;
+		pEntity->m_iName = MAKE_STRING(pooled.c_str());
+	}
+
+	g_FakeEntities.push_back(pEntity);
+	return pEntity->index;
+}
+
+FakeEntity *GetFakeEntity(int index)
+{
+	if (index < 0 || index >= (int)g_FakeEntities.size())
+		return nullptr;
+
+	return g_FakeEntities[index];
+}
+
+int CreateFakeRelay(const char *pszName)
+{
+	return AddFakeEntity("logic_relay", &g_RelayMap, pszName);
+}
+
+void ClearFakeOutputs()
+{
+	for (size_t i = 0; i < g_FakeEntities.size(); i++)
+	{
+		FakeEntity *pEntity = g_FakeEntities[i];
+		FreeOutputActions(AsOutput(pEntity->m_OnUser1));
+		FreeOutputActions(AsOutput(pEntity->m_OnTrigger));
+		FreeOutputActions(AsOutput(pEntity->m_OnSpawn));
+	}
+}
+
+unsigned int FakeKeyValueCalls()
+{
+	return g_FakeKeyValueCalls;
+}
+
+static FakeEntity *ToFake(CBaseEntity *pEntity)
+{
+	return reinterpret_cast<FakeEntity *>(pEntity);
+}
+
+/**
+ * IGameHelpers; entity references are plain indices
+ */
+
+static CBaseEntity *GameHelpers_ReferenceToEntity(void *pThis, cell_t entRef)
+{
+	return reinterpret_cast<CBaseEntity *>(GetFakeEntity(entRef));
+}
+
+static cell_t GameHelpers_EntityToReference(void *pThis, CBaseEntity *pEntity)
+{
+	return ToFake(pEntity)->index;
+}
+
+static int GameHelpers_ReferenceToIndex(void *pThis, cell_t entRef)
+{
+	return entRef;
+}
+
+static cell_t GameHelpers_ReferenceToBCompatRef(void *pThis, cell_t entRef)
+{
+	return entRef;
+}
+
+static cell_t GameHelpers_EntityToBCompatRef(void *pThis, CBaseEntity *pEntity)
+{
+	return ToFake(pEntity)->index;
+}
+
+static datamap_t *GameHelpers_GetDataMap(void *pThis, CBaseEntity *pEntity)
+{
+	return ToFake(pEntity)->pMap;
+}
+
+static const char *GameHelpers_GetEntityClassname(void *pThis, CBaseEntity *pEntity)
+{
+	return ToFake(pEntity)->classname;
+}
+
+static bool GameHelpers_FindDataMapInfo(void *pThis, datamap_t *pMap, const char *pszName, sm_datatable_info_t *pDataTable)
+{
+	for (; pMap != NULL; pMap = pMap->baseMap)
+	{
+		for (int i = 0; i < pMap->dataNumFields; i++)
+		{
+			typedescription_t *pTypeDesc = &pMap->dataDesc[i];
+			if (strcmp(pTypeDesc->fieldName, pszName) != 0)
+				continue;
+
+			pDataTable->prop = pTypeDesc;
+			pDataTable->actual_offset = TD_FIELD_OFFSET(pTypeDesc);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static const char *GameHelpers_GetCurrentMap(void *pThis)
+{
+	return "outputinfo_test";
+}
+
+/**
+ * IServerTools
+ */
+
+static void *ServerTools_FirstEntity(void *pThis)
+{
+	return GetFakeEntity(0);
+}
+
+static void *ServerTools_NextEntity(void *pThis, void *pEntity)
+{
+	return GetFakeEntity(reinterpret_cast<FakeEntity *>(pEntity)->index + 1);
+}
+
+static bool ServerTools_SetKeyValue(void *pThis, void *pEntity, const char *pszField, const char *pszValue)
+{
+	g_FakeKeyValueCalls++;
+
+	if (strcmp(pszField, "targetname") != 0)
+		return false;
+
+	// The game runs keyvalue strings through AllocPooledString too
+	const std::string &pooled = *g_FakeStrings.insert(pszValue).first;
+	reinterpret_cast<FakeEntity *>(pEntity)->m_iName = MAKE_STRING(pooled.c_str());
+	return true;
+}
+
+/**
+ * IGameConfig; only the action pool resolves
+ */
+
+static bool GameConfig_GetMemSig(void *pThis, const char *key, void **addr)
+{
+	*addr = nullptr;
+	return false;
+}
+
+static bool GameConfig_GetAddress(void *pThis, const char *key, void **addr)
+{
+	if (strcmp(key, "CEventAction::s_Allocator") == 0)
+	{
+		*addr = g_pFakeActionPool;
+		return true;
+	}
+
+	*addr = nullptr;
+	return false;
+}
+
+/**
+ * IPluginContext; addresses are byte offsets into the context's memory
+ */
+
+static int Context_LocalToPhysAddr(FakePluginContext *pThis, cell_t local_addr, cell_t **phys_addr)
+{
+	*phys_addr = &pThis->CellAt(local_addr);
+	return SP_ERROR_NONE;
+}
+
+static int Context_LocalToString(FakePluginContext *pThis, cell_t local_addr, char **addr)
+{
+	*addr = pThis->StringAt(local_addr);
+	return SP_ERROR_NONE;
+}
+
+static int Context_StringToLocal(FakePluginContext *pThis, cell_t local_addr, size_t bytes, const char *source)
+{
+	if (bytes == 0)
+		return SP_ERROR_NONE;
+
+	// Truncates like SourcePawn's
+	size_t length = strlen(source);
+	if (length >= bytes)
+		length = bytes - 1;
+
+	char *dest = pThis->StringAt(local_addr);
+	memcpy(dest, source, length);
+	dest[length] = '\0';
+	return SP_ERROR_NONE;
+}
+
+static int Context_StringToLocalUTF8(FakePluginContext *pThis, cell_t local_addr, size_t maxbytes, const char *source, size_t *wrtnbytes)
+{
+	Context_StringToLocal(pThis, local_addr, maxbytes, source);
+	if (wrtnbytes)
+		*wrtnbytes = strlen(pThis->StringAt(local_addr));
+
+	return SP_ERROR_NONE;
+}
+
+static cell_t Context_ThrowNativeError(FakePluginContext *pThis, const char *msg, ...)
+{
+	va_list ap;
+	va_start(ap, msg);
+	vsnprintf(pThis->m_szError, sizeof(pThis->m_szError), msg, ap);
+	va_end(ap);
+
+	return 0;
+}
+
+static IPluginRuntime *Context_GetRuntime(FakePluginContext *pThis)
+{
+	// Only ever compared, as the deferred edit queue does
+	return reinterpret_cast<IPluginRuntime *>(pThis);
+}
+
+static SourceMod::IdentityToken_t *Context_GetIdentity(FakePluginContext *pThis)
+{
+	return nullptr;
+}
+
+static FakeVTable<IPluginContext> g_ContextVTable;
+
+FakePluginContext::FakePluginContext() : vptr(g_ContextVTable.Slots())
+{
+	Reset();
+}
+
+void FakePluginContext::Reset()
+{
+	// Address 0 stays unused, like a plugin's NULL
+	m_Top = sizeof(cell_t);
+	m_szError[0] = '\0';
+}
+
+cell_t FakePluginContext::Buffer(size_t bytes)
+{
+	size_t addr = m_Top;
+	m_Top += (bytes + sizeof(cell_t) - 1) & ~(sizeof(cell_t) - 1);
+
+	if (m_Top > kMemory)
+	{
+		fprintf(stderr, "Fake plugin memory exhausted\n");
+		abort();
+	}
+
+	memset(&m_Memory[addr], 0, bytes);
+	return (cell_t)addr;
+}
+
+cell_t FakePluginContext::String(const char *pszValue)
+{
+	size_t length = strlen(pszValue) + 1;
+	cell_t addr = Buffer(length);
+	memcpy(&m_Memory[addr], pszValue, length);
+	return addr;
+}
+
+cell_t FakePluginContext::Cell(cell_t value)
+{
+	cell_t addr = Buffer(sizeof(cell_t));
+	CellAt(addr) = value;
+	return addr;
+}
+
+/**
+ * Natives
+ */
+
+static const sp_nativeinfo_t *g_NativeTables[] =
+{
+	MyNatives,
+	g_ActionPoolNatives,
+	g_EditQueueNatives,
+};
+
+SPVM_NATIVE_FUNC FindNative(const char *pszName)
+{
+	for (size_t i = 0; i < sizeof(g_NativeTables) / sizeof(g_NativeTables[0]); i++)
+	{
+		for (const sp_nativeinfo_t *pNative = g_NativeTables[i]; pNative->name != NULL; pNative++)
+		{
+			if (strcmp(pNative->name, pszName) == 0)
+				return pNative->func;
+		}
+	}
+
+	return nullptr;
+}
+
+cell_t CallNative(FakePluginContext &context, const char *pszName, std::initializer_list<cell_t> args)
+{
+	SPVM_NATIVE_FUNC pfnNative = FindNative(pszName);
+	if (!pfnNative)
+	{
+		fprintf(stderr, "Native %s is not registered\n", pszName);
+		abort();
+	}
+
+	cell_t params[SP_MAX_EXEC_PARAMS + 1];
+	params[0] = (cell_t)args.size();
+
+	cell_t *pParam = &params[1];
+	for (cell_t arg : args)
+		*pParam++ = arg;
+
+	context.m_szError[0] = '\0';
+	return pfnNative(context.Get(), params);
+}
+
+/**
+ * Setup
+ */
+
+bool InstallFakes(char *error, size_t maxlength)
+{
+	static FakeVTable<IGameHelpers> s_GameHelpers;
+	s_GameHelpers.Set(&IGameHelpers::ReferenceToEntity, reinterpret_cast<void *>(&GameHelpers_ReferenceToEntity));
+	s_GameHelpers.Set(&IGameHelpers::EntityToReference, reinterpret_cast<void *>(&GameHelpers_EntityToReference));
+	s_GameHelpers.Set(&IGameHelpers::ReferenceToIndex, reinterpret_cast<void *>(&GameHelpers_ReferenceToIndex));
+	s_GameHelpers.Set(&IGameHelpers::ReferenceToBCompatRef, reinterpret_cast<void *>(&GameHelpers_ReferenceToBCompatRef));
+	s_GameHelpers.Set(&IGameHelpers::EntityToBCompatRef, reinterpret_cast<void *>(&GameHelpers_EntityToBCompatRef));
+	s_GameHelpers.Set(&IGameHelpers::GetDataMap, reinterpret_cast<void *>(&GameHelpers_GetDataMap));
+	s_GameHelpers.Set(static_cast<const char *(IGameHelpers::*)(CBaseEntity *)>(&IGameHelpers::GetEntityClassname),
+		reinterpret_cast<void *>(&GameHelpers_GetEntityClassname));
+	s_GameHelpers.Set(&IGameHelpers::FindDataMapInfo, reinterpret_cast<void *>(&GameHelpers_FindDataMapInfo));
+	s_GameHelpers.Set(&IGameHelpers::GetCurrentMap, reinterpret_cast<void *>(&GameHelpers_GetCurrentMap));
+	g_FakeGameHelpers = s_GameHelpers.Slots();
+	gamehelpers = reinterpret_cast<IGameHelpers *>(&g_FakeGameHelpers);
+
+	static FakeVTable<IServerTools> s_ServerTools;
+	s_ServerTools.Set(&IServerTools::FirstEntity, reinterpret_cast<void *>(&ServerTools_FirstEntity));
+	s_ServerTools.Set(&IServerTools::NextEntity, reinterpret_cast<void *>(&ServerTools_NextEntity));
+	s_ServerTools.Set(static_cast<bool (IServerTools::*)(void *, const char *, const char *)>(&IServerTools::SetKeyValue),
+		reinterpret_cast<void *>(&ServerTools_SetKeyValue));
+	g_FakeServerTools = s_ServerTools.Slots();
+	servertools = reinterpret_cast<IServerTools *>(&g_FakeServerTools);
+
+	static FakeVTable<IGameConfig> s_GameConfig;
+	s_GameConfig.Set(&IGameConfig::GetMemSig, reinterpret_cast<void *>(&GameConfig_GetMemSig));
+	s_GameConfig.Set(&IGameConfig::GetAddress, reinterpret_cast<void *>(&GameConfig_GetAddress));
+	g_FakeGameConfig = s_GameConfig.Slots();
+	IGameConfig *pGameConf = reinterpret_cast<IGameConfig *>(&g_FakeGameConfig);
+
+	g_ContextVTable.Set(&IPluginContext::LocalToPhysAddr, reinterpret_cast<void *>(&Context_LocalToPhysAddr));
+	g_ContextVTable.Set(&IPluginContext::LocalToString, reinterpret_cast<void *>(&Context_LocalToString));
+	g_ContextVTable.Set(&IPluginContext::StringToLocal, reinterpret_cast<void *>(&Context_StringToLocal));
+	g_ContextVTable.Set(&IPluginContext::StringToLocalUTF8, reinterpret_cast<void *>(&Context_StringToLocalUTF8));
+	g_ContextVTable.Set(&IPluginContext::ThrowNativeError, reinterpret_cast<void *>(&Context_ThrowNativeError));
+	g_ContextVTable.Set(&IPluginContext::GetRuntime, reinterpret_cast<void *>(&Context_GetRuntime));
+	g_ContextVTable.Set(&IPluginContext::GetIdentity, reinterpret_cast<void *>(&Context_GetIdentity));
+
+	g_EntityVTable.Set(&IServerUnknown::GetBaseEntity, reinterpret_cast<void *>(&Entity_GetBaseEntity));
+
+	DescribeDataMaps();
+	AddFakeEntity("worldspawn", &g_BaseMap, "");
+
+	// Set up like the game's DEFINE_FIXEDSIZE_ALLOCATOR(CEventAction, 128, GROW_SLOW)
+	g_pFakeActionPool = new CUtlMemoryPool(sizeof(CEventAction), 128, CUtlMemoryPool::GROW_SLOW, "CEventAction::s_Allocator");
+
+	if (!g_ActionAllocator.Init(pGameConf, error, maxlength))
+		return false;
+
+	if (!g_ActionAllocator.UsesGamePool())
+	{
+		snprintf(error, maxlength, "The action allocator did not take the fake game pool");
+		return false;
+	}
+
+	g_StringPool.Init(pGameConf);
+	g_StringPool.OnLevelStart();
+
+	return true;
+}
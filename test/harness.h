@@ -0,0 +1,209 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_TEST_HARNESS_H_
+#define _INCLUDE_OUTPUTINFO_TEST_HARNESS_H_
+
+/**
+ * @file harness.h
+ * @brief Offline stand-ins for the game and SourceMod, for running natives without srcds.
+ */
+
+#include "extension.h"
+#include "entityoutput.h"
+#include <initializer_list>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * A vtable for interface T whose slots we fill with free functions taking the
+ * object as their first argument. Slots are found from pointers to member
+ * functions as laid out by the Itanium C++ ABI (every Linux compiler), so a
+ * fake only names the methods it implements and doesn't depend on which
+ * SourceMod or SDK version declares which others. Unset slots abort.
+ */
+template <typename T>
+class FakeVTable
+{
+public:
+	static const int kSlots = 256;
+
+	FakeVTable()
+	{
+		for (int i = 0; i < kSlots; i++)
+			m_Slots[i] = reinterpret_cast<void *>(&UnexpectedCall);
+	}
+
+	template <typename M>
+	void Set(M method, void *pfn)
+	{
+		m_Slots[SlotOf(method)] = pfn;
+	}
+
+	void **Slots() { return m_Slots; }
+
+	template <typename M>
+	static int SlotOf(M method)
+	{
+		static_assert(sizeof(M) == 2 * sizeof(intptr_t), "Itanium pointer to member function expected");
+
+		// A virtual method's pointer holds 1 + its byte offset into the vtable
+		intptr_t words[2];
+		memcpy(words, &method, sizeof(words));
+		return (int)((words[0] - 1) / (intptr_t)sizeof(void *));
+	}
+
+private:
+	static void UnexpectedCall()
+	{
+		fprintf(stderr, "Unexpected call into a fake interface\n");
+		abort();
+	}
+
+private:
+	void *m_Slots[kSlots];
+};
+
+/**
+ * Layout of every fake entity. The datamaps built by InstallFakes describe
+ * it, with the outputs split between a base class and a derived one.
+ */
+struct FakeEntity
+{
+	void **vptr;		/**< IServerUnknown, for servertools->FirstEntity() */
+	string_t m_iName;
+	bool m_bDisabled;
+	alignas(CBaseEntityOutput) unsigned char m_OnUser1[sizeof(CBaseEntityOutput)];
+	alignas(CBaseEntityOutput) unsigned char m_OnTrigger[sizeof(CBaseEntityOutput)];
+	alignas(CBaseEntityOutput) unsigned char m_OnSpawn[sizeof(CBaseEntityOutput)];
+
+	int index;
+	const char *classname;
+	datamap_t *pMap;
+};
+
+inline CBaseEntityOutput *AsOutput(unsigned char *pField)
+{
+	return reinterpret_cast<CBaseEntityOutput *>(pField);
+}
+
+/**
+ * Plugin side of a native call: a flat memory block addressed like a
+ * plugin's, and the last error thrown.
+ */
+class FakePluginContext
+{
+public:
+	FakePluginContext();
+
+	IPluginContext *Get() { return reinterpret_cast<IPluginContext *>(this); }
+
+	/**
+	 * @brief Frees every local and clears the error.
+	 */
+	void Reset();
+
+	cell_t String(const char *pszValue);
+	cell_t Buffer(size_t bytes);
+	cell_t Cell(cell_t value);
+
+	char *StringAt(cell_t addr) { return &m_Memory[addr]; }
+	cell_t &CellAt(cell_t addr) { return *reinterpret_cast<cell_t *>(&m_Memory[addr]); }
+
+	bool HasError() { return m_szError[0] != '\0'; }
+	const char *Error() { return m_szError; }
+
+public:
+	void **vptr;
+	char m_szError[256];
+
+private:
+	static const size_t kMemory = 1 << 16;
+
+	char m_Memory[kMemory];
+	size_t m_Top;
+};
+
+/**
+ * @brief Installs the fake gamehelpers and servertools, builds the fake
+ * world, and initializes the modules the natives need.
+ *
+ * @return				False if a module refused the fakes.
+ */
+bool InstallFakes(char *error, size_t maxlength);
+
+/**
+ * @brief Returns the entity at an index; index 0 is worldspawn.
+ */
+FakeEntity *GetFakeEntity(int index);
+
+/**
+ * @brief Adds a logic_relay to the fake world.
+ *
+ * @return				Its entity index.
+ */
+int CreateFakeRelay(const char *pszName);
+
+/**
+ * @brief Frees the actions of every output of every fake entity.
+ */
+void ClearFakeOutputs();
+
+/**
+ * @brief Number of SetKeyValue calls servertools has served.
+ */
+unsigned int FakeKeyValueCalls();
+
+/**
+ * @brief Calls a native the extension registers, by name, as a plugin would.
+ */
+cell_t CallNative(FakePluginContext &context, const char *pszName, std::initializer_list<cell_t> args);
+
+/**
+ * @brief Looks up a native the extension registers.
+ */
+SPVM_NATIVE_FUNC FindNative(const char *pszName);
+
+/**
+ * @brief Runs every behavior test.
+ *
+ * @return				Number of failed checks.
+ */
+int RunTests();
+
+/**
+ * @brief Times the natives and the modules behind them.
+ */
+void RunBenchmarks(int samples);
+
+#endif // _INCLUDE_OUTPUTINFO_TEST_HARNESS_H_
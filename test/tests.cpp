@@ -0,0 +1,310 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "harness.h"
+
+/**
+ * @file tests.cpp
+ * @brief Behavior tests of the natives, run against the fake world.
+ */
+
+static int g_Checks = 0;
+static int g_Failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		g_Checks++; \
+		if (!(cond)) \
+		{ \
+			g_Failures++; \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+static cell_t Insert(FakePluginContext &ctx, int entity, const char *pszOutput, const char *pszTarget, int index)
+{
+	return CallNative(ctx, "InsertOutputAction", { entity, ctx.String(pszOutput), ctx.String(pszTarget),
+		ctx.String("Trigger"), ctx.String(""), sp_ftoc(0.0f), EVENT_FIRE_ALWAYS, index });
+}
+
+static cell_t Count(FakePluginContext &ctx, int entity, const char *pszOutput)
+{
+	return CallNative(ctx, "GetOutputActionCount", { entity, ctx.String(pszOutput) });
+}
+
+static bool TargetIs(FakePluginContext &ctx, int entity, const char *pszOutput, int index, const char *pszTarget)
+{
+	cell_t buffer = ctx.Buffer(64);
+	if (!CallNative(ctx, "GetOutputActionTarget", { entity, ctx.String(pszOutput), index, buffer, 64 }))
+		return false;
+
+	return strcmp(ctx.StringAt(buffer), pszTarget) == 0;
+}
+
+static void TestEntityResolution(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_resolve");
+
+	CHECK(Count(ctx, 4095, "m_OnTrigger") == 0);
+	CHECK(strcmp(ctx.Error(), "Invalid Entity index 4095 (4095)") == 0);
+
+	// An unknown output isn't an error, there's just nothing on it
+	CHECK(Count(ctx, relay, "m_OnNothing") == 0);
+	CHECK(!ctx.HasError());
+
+	CHECK(Insert(ctx, relay, "m_OnNothing", "door", 0) == 0);
+	CHECK(!ctx.HasError());
+}
+
+static void TestInsertIndices(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_insert");
+
+	// An empty list takes index 0
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "b", 0) == 1);
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 1);
+
+	// Index count appends, index 0 goes in front
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "c", 1) == 1);
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "a", 0) == 1);
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 3);
+	CHECK(TargetIs(ctx, relay, "m_OnTrigger", 0, "a"));
+	CHECK(TargetIs(ctx, relay, "m_OnTrigger", 1, "b"));
+	CHECK(TargetIs(ctx, relay, "m_OnTrigger", 2, "c"));
+
+	// Past count, or negative, fails without touching the list
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "d", 4) == 0);
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "d", -1) == 0);
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 3);
+
+	CHECK(!TargetIs(ctx, relay, "m_OnTrigger", 3, "c"));
+}
+
+static void TestStrings(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_strings");
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "a_rather_long_target", 0) == 1);
+
+	// The plugin's buffer size bounds the copy
+	cell_t small = ctx.Buffer(8);
+	CHECK(CallNative(ctx, "GetOutputActionTarget", { relay, ctx.String("m_OnTrigger"), 0, small, 8 }) == 1);
+	CHECK(strcmp(ctx.StringAt(small), "a_rathe") == 0);
+
+	CHECK(CallNative(ctx, "SetOutputActionTarget", { relay, ctx.String("m_OnTrigger"), 0, ctx.String("short") }) == 1);
+	CHECK(TargetIs(ctx, relay, "m_OnTrigger", 0, "short"));
+
+	// Equal strings are one string_t, so ids compare like the strings
+	cell_t id = CallNative(ctx, "GetOutputActionTargetId", { relay, ctx.String("m_OnTrigger"), 0 });
+	CHECK(id != 0);
+	CHECK(id == CallNative(ctx, "InternOutputString", { ctx.String("short") }));
+	CHECK(id != CallNative(ctx, "InternOutputString", { ctx.String("Short") }));
+}
+
+static void TestOffsetCache(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_offsets");
+
+	cell_t hits = ctx.Cell(0), misses = ctx.Cell(0), negative = ctx.Cell(0);
+	CallNative(ctx, "GetOutputOffsetCacheStats", { hits, misses, negative });
+	cell_t baseHits = ctx.CellAt(hits), baseMisses = ctx.CellAt(misses), baseNegative = ctx.CellAt(negative);
+
+	// First lookup of a name misses, the next one hits
+	CHECK(Count(ctx, relay, "m_OnSpawn") == 0);
+	CHECK(Count(ctx, relay, "m_OnSpawn") == 0);
+	CallNative(ctx, "GetOutputOffsetCacheStats", { hits, misses, negative });
+	CHECK(ctx.CellAt(misses) - baseMisses == 1);
+	CHECK(ctx.CellAt(hits) - baseHits == 1);
+
+	// A field that isn't an output is cached as such
+	CHECK(Count(ctx, relay, "m_bDisabled") == 0);
+	CHECK(Count(ctx, relay, "m_bDisabled") == 0);
+	CallNative(ctx, "GetOutputOffsetCacheStats", { hits, misses, negative });
+	CHECK(ctx.CellAt(misses) - baseMisses == 2);
+	CHECK(ctx.CellAt(negative) - baseNegative == 1);
+
+	// Outputs of a base class land at their own offsets
+	CHECK(Insert(ctx, relay, "m_OnUser1", "base", 0) == 1);
+	CHECK(Insert(ctx, relay, "m_OnSpawn", "derived", 0) == 1);
+
+	FakeEntity *pEntity = GetFakeEntity(relay);
+	CHECK(AsOutput(pEntity->m_OnUser1)->m_ActionList != NULL);
+	CHECK(strcmp(AsOutput(pEntity->m_OnUser1)->m_ActionList->m_iTarget.ToCStr(), "base") == 0);
+	CHECK(strcmp(AsOutput(pEntity->m_OnSpawn)->m_ActionList->m_iTarget.ToCStr(), "derived") == 0);
+	CHECK(AsOutput(pEntity->m_OnTrigger)->m_ActionList == NULL);
+}
+
+static void TestRemove(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_remove");
+	for (int i = 0; i < 4; i++)
+		CHECK(Insert(ctx, relay, "m_OnTrigger", "x", i) == 1);
+
+	CHECK(CallNative(ctx, "RemoveOutputAction", { relay, ctx.String("m_OnTrigger"), 1 }) == 1);
+	CHECK(CallNative(ctx, "RemoveOutputAction", { relay, ctx.String("m_OnTrigger"), 3 }) == 0);
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 3);
+
+	// Zero times to fire takes the action out, as the game would after its last fire
+	CHECK(CallNative(ctx, "SetOutputActionTimesToFire", { relay, ctx.String("m_OnTrigger"), 0, 0 }) == 1);
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 2);
+
+	CHECK(CallNative(ctx, "ClearOutput", { relay, ctx.String("m_OnTrigger") }) == 2);
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 0);
+}
+
+static void TestActionPool(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_pool");
+
+	cell_t count = ctx.Cell(0), peak = ctx.Cell(0), free = ctx.Cell(0), blobs = ctx.Cell(0);
+	CHECK(CallNative(ctx, "GetOutputActionPoolStats", { count, peak, free, blobs }) == 1);
+	cell_t baseCount = ctx.CellAt(count);
+
+	for (int i = 0; i < 10; i++)
+		Insert(ctx, relay, "m_OnTrigger", "pooled", 0);
+
+	CallNative(ctx, "GetOutputActionPoolStats", { count, peak, free, blobs });
+	CHECK(ctx.CellAt(count) - baseCount == 10);
+	CHECK(ctx.CellAt(peak) >= ctx.CellAt(count));
+
+	CallNative(ctx, "ClearOutput", { relay, ctx.String("m_OnTrigger") });
+	CallNative(ctx, "GetOutputActionPoolStats", { count, peak, free, blobs });
+	CHECK(ctx.CellAt(count) == baseCount);
+
+	// Reserving leaves the blocks free in the pool
+	CHECK(CallNative(ctx, "ReserveOutputActions", { 300 }) >= 300);
+	CHECK(CallNative(ctx, "ReserveOutputActions", { -1 }) == 0);
+	CHECK(ctx.HasError());
+}
+
+static void TestInterning(FakePluginContext &ctx)
+{
+	unsigned int calls = FakeKeyValueCalls();
+
+	// Without AllocPooledString a miss goes through worldspawn's targetname
+	cell_t first = CallNative(ctx, "InternOutputString", { ctx.String("interned_once") });
+	CHECK(FakeKeyValueCalls() - calls == 1);
+
+	cell_t second = CallNative(ctx, "InternOutputString", { ctx.String("interned_once") });
+	CHECK(FakeKeyValueCalls() - calls == 1);
+	CHECK(first == second);
+
+	// Searching never interns the query
+	int relay = CreateFakeRelay("relay_intern");
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "interned_once", 0) == 1);
+	calls = FakeKeyValueCalls();
+	CHECK(CallNative(ctx, "FindOutputAction", { relay, ctx.String("m_OnTrigger"), 0, ctx.String("interned_once"),
+		ctx.String(""), ctx.String(""), sp_ftoc(-1.0f), 0 }) == 0);
+	CHECK(CallNative(ctx, "FindOutputAction", { relay, ctx.String("m_OnTrigger"), 0, ctx.String("never_interned"),
+		ctx.String(""), ctx.String(""), sp_ftoc(-1.0f), 0 }) == -1);
+	CHECK(FakeKeyValueCalls() == calls);
+
+	// worldspawn keeps its own name
+	CHECK(GetFakeEntity(0)->m_iName.ToCStr()[0] == '\0');
+}
+
+static void TestDeferredEdits(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_deferred");
+
+	cell_t failed = CallNative(ctx, "GetFailedOutputEdits", {});
+	CallNative(ctx, "SetOutputEditsDeferred", { 1 });
+
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "first", 0) == 1);
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "too_far", 5) == 1);
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 0);
+	CHECK(CallNative(ctx, "GetPendingOutputEdits", {}) == 2);
+
+	CHECK(CallNative(ctx, "FlushOutputEdits", {}) == 1);
+	CHECK(CallNative(ctx, "GetFailedOutputEdits", {}) - failed == 1);
+	CHECK(CallNative(ctx, "GetPendingOutputEdits", {}) == 0);
+
+	CallNative(ctx, "SetOutputEditsDeferred", { 0 });
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 1);
+	CHECK(TargetIs(ctx, relay, "m_OnTrigger", 0, "first"));
+}
+
+static void TestDeferredInsertThenSet(FakePluginContext &ctx)
+{
+	int relay = CreateFakeRelay("relay_deferred_set");
+
+	CallNative(ctx, "SetOutputEditsDeferred", { 1 });
+
+	// The list is still empty when the set is queued; the insert ahead of it fills index 0
+	CHECK(Insert(ctx, relay, "m_OnTrigger", "inserted", 0) == 1);
+	CHECK(CallNative(ctx, "SetOutputActionTarget", { relay, ctx.String("m_OnTrigger"), 0, ctx.String("retargeted") }) == 1);
+	CHECK(CallNative(ctx, "SetOutputActionDelay", { relay, ctx.String("m_OnTrigger"), 0, sp_ftoc(2.0f) }) == 1);
+	CHECK(CallNative(ctx, "GetPendingOutputEdits", {}) == 3);
+
+	CHECK(CallNative(ctx, "FlushOutputEdits", {}) == 3);
+	CallNative(ctx, "SetOutputEditsDeferred", { 0 });
+
+	CHECK(Count(ctx, relay, "m_OnTrigger") == 1);
+	CHECK(TargetIs(ctx, relay, "m_OnTrigger", 0, "retargeted"));
+	CHECK(sp_ctof(CallNative(ctx, "GetOutputActionDelay", { relay, ctx.String("m_OnTrigger"), 0 })) == 2.0f);
+
+	// Without a queued insert the set still fails, only later
+	CHECK(CallNative(ctx, "RemoveOutputAction", { relay, ctx.String("m_OnTrigger"), 0 }) == 1);
+	cell_t failed = CallNative(ctx, "GetFailedOutputEdits", {});
+	CallNative(ctx, "SetOutputEditsDeferred", { 1 });
+	CHECK(CallNative(ctx, "SetOutputActionTarget", { relay, ctx.String("m_OnTrigger"), 0, ctx.String("nothing") }) == 1);
+	CHECK(CallNative(ctx, "FlushOutputEdits", {}) == 0);
+	CHECK(CallNative(ctx, "GetFailedOutputEdits", {}) - failed == 1);
+	CallNative(ctx, "SetOutputEditsDeferred", { 0 });
+}
+
+int RunTests()
+{
+	static FakePluginContext ctx;
+
+	void (*tests[])(FakePluginContext &) =
+	{
+		TestEntityResolution,
+		TestInsertIndices,
+		TestStrings,
+		TestOffsetCache,
+		TestRemove,
+		TestActionPool,
+		TestInterning,
+		TestDeferredEdits,
+		TestDeferredInsertThenSet,
+	};
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+	{
+		ctx.Reset();
+		tests[i](ctx);
+	}
+
+	ClearFakeOutputs();
+
+	printf("%d checks, %d failed\n", g_Checks, g_Failures);
+	return g_Failures;
+}
@@ -0,0 +1,301 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "throttle.h"
+#include "entityoutput.h"
+#include "outputkey.h"
+#include <algorithm>
+
+/**
+ * @file throttle.cpp
+ * @brief Per-output fire rate limits, enforced in the FireOutput detour.
+ */
+
+OutputThrottle g_OutputThrottle;
+
+static void OnGameFrame(bool simulating)
+{
+	g_OutputThrottle.ProcessPending();
+}
+
+static bool CompareOutput(const OutputThrottle::Entry &entry, CBaseEntityOutput *pOutput)
+{
+	return entry.pOutput < pOutput;
+}
+
+void OutputThrottle::Init()
+{
+	smutils->AddGameFrameHook(OnGameFrame);
+}
+
+void OutputThrottle::Shutdown()
+{
+	smutils->RemoveGameFrameHook(OnGameFrame);
+	Clear();
+}
+
+void OutputThrottle::Clear()
+{
+	m_Entries.clear();
+	m_NumPending = 0;
+}
+
+OutputThrottle::Entry *OutputThrottle::Find(CBaseEntityOutput *pOutput)
+{
+	auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), pOutput, CompareOutput);
+	if (it == m_Entries.end() || it->pOutput != pOutput)
+		return nullptr;
+
+	return &*it;
+}
+
+void OutputThrottle::Set(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, int maxFires, float window, OutputThrottleMode mode)
+{
+	auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), pOutput, CompareOutput);
+	if (it == m_Entries.end() || it->pOutput != pOutput)
+	{
+		Entry entry;
+		entry.pOutput = pOutput;
+		entry.windowStart = -1.0f;
+		entry.fires = 0;
+		entry.suppressed = 0;
+		entry.pending = false;
+		it = m_Entries.insert(it, entry);
+	}
+
+	it->entref = gamehelpers->EntityToReference(pEntity);
+	it->maxFires = maxFires;
+	it->window = window;
+	it->mode = mode;
+
+	if (mode != OutputThrottle_Coalesce && it->pending)
+	{
+		it->pending = false;
+		m_NumPending--;
+	}
+}
+
+bool OutputThrottle::Remove(CBaseEntityOutput *pOutput)
+{
+	auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), pOutput, CompareOutput);
+	if (it == m_Entries.end() || it->pOutput != pOutput)
+		return false;
+
+	if (it->pending)
+		m_NumPending--;
+
+	m_Entries.erase(it);
+	return true;
+}
+
+bool OutputThrottle::IsLive(size_t index)
+{
+	// The output's memory may belong to another entity by now
+	if (gamehelpers->ReferenceToEntity(m_Entries[index].entref))
+		return true;
+
+	if (m_Entries[index].pending)
+		m_NumPending--;
+
+	m_Entries.erase(m_Entries.begin() + index);
+	return false;
+}
+
+void OutputThrottle::Flush(size_t index)
+{
+	Entry &entry = m_Entries[index];
+	entry.pending = false;
+	entry.windowStart = gpGlobals->curtime;
+	entry.fires = 1;
+	m_NumPending--;
+
+	// Copied, the fire may change the table
+	CBaseEntityOutput *pOutput = entry.pOutput;
+	FireOutputValue value = entry.value;
+	CBaseEntity *pActivator = entry.activator != -1 ? gamehelpers->ReferenceToEntity(entry.activator) : nullptr;
+	CBaseEntity *pCaller = gamehelpers->ReferenceToEntity(entry.caller);
+	float delay = entry.delay;
+
+	g_FireHooks.FireOutput(pOutput, value, pActivator, pCaller, delay);
+}
+
+bool OutputThrottle::OnFireOutput(CBaseEntityOutput *pOutput, const FireOutputValue &value, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay)
+{
+	if (m_Entries.empty())
+		return true;
+
+	auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), pOutput, CompareOutput);
+	if (it == m_Entries.end() || it->pOutput != pOutput)
+		return true;
+
+	size_t index = it - m_Entries.begin();
+	if (!IsLive(index))
+		return true;
+
+	float now = gpGlobals->curtime;
+	if (now - m_Entries[index].windowStart >= m_Entries[index].window)
+	{
+		if (m_Entries[index].pending)
+		{
+			Flush(index);
+
+			// Look it up again, the flushed fire may have changed the table
+			Entry *pEntry = Find(pOutput);
+			if (!pEntry)
+				return true;
+
+			index = pEntry - &m_Entries[0];
+		}
+		else
+		{
+			m_Entries[index].windowStart = now;
+			m_Entries[index].fires = 0;
+		}
+	}
+
+	Entry &entry = m_Entries[index];
+	if (entry.fires < entry.maxFires)
+	{
+		entry.fires++;
+		return true;
+	}
+
+	entry.suppressed++;
+
+	if (entry.mode == OutputThrottle_Coalesce)
+	{
+		if (!entry.pending)
+			m_NumPending++;
+
+		entry.pending = true;
+		entry.value = value;
+		entry.activator = pActivator ? gamehelpers->EntityToReference(pActivator) : -1;
+		entry.caller = pCaller ? gamehelpers->EntityToReference(pCaller) : -1;
+		entry.delay = flDelay;
+	}
+
+	return false;
+}
+
+void OutputThrottle::ProcessPending()
+{
+	if (m_NumPending == 0)
+		return;
+
+	float now = gpGlobals->curtime;
+	for (size_t i = 0; i < m_Entries.size() && m_NumPending > 0; i++)
+	{
+		if (!m_Entries[i].pending || now - m_Entries[i].windowStart < m_Entries[i].window)
+			continue;
+
+		if (!IsLive(i))
+		{
+			i--;
+			continue;
+		}
+
+		CBaseEntityOutput *pOutput = m_Entries[i].pOutput;
+		Flush(i);
+
+		// Resume after this output, wherever the fire moved it
+		i = std::lower_bound(m_Entries.begin(), m_Entries.end(), pOutput, CompareOutput) - m_Entries.begin();
+		if (i < m_Entries.size() && m_Entries[i].pOutput != pOutput)
+			i--;
+	}
+}
+
+template <OutputParamReader Read>
+cell_t SetOutputThrottle(IPluginContext *pContext, const cell_t *params)
+{
+	if (!g_FireHooks.IsAvailable())
+	{
+		return pContext->ThrowNativeError("FireOutput hooks are unavailable, check the error log");
+	}
+
+	float window = sp_ctof(params[4]);
+	if (params[3] < 1 || window <= 0.0f)
+	{
+		return pContext->ThrowNativeError("Invalid throttle of %d fires per %f seconds", params[3], window);
+	}
+
+	if (params[5] != OutputThrottle_Drop && params[5] != OutputThrottle_Coalesce)
+	{
+		return pContext->ThrowNativeError("Invalid throttle mode %d", params[5]);
+	}
+
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput) || pEntityOutput == NULL)
+		return 0;
+
+	g_OutputThrottle.Set(pEntity, pEntityOutput, params[3], window, (OutputThrottleMode)params[5]);
+	return 1;
+}
+
+template <OutputParamReader Read>
+cell_t RemoveOutputThrottle(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput) || pEntityOutput == NULL)
+		return 0;
+
+	return g_OutputThrottle.Remove(pEntityOutput);
+}
+
+template <OutputParamReader Read>
+cell_t GetOutputThrottleSuppressed(IPluginContext *pContext, const cell_t *params)
+{
+	CBaseEntity *pEntity;
+	CBaseEntityOutput *pEntityOutput;
+	if (!Read(pContext, params, &pEntity, &pEntityOutput))
+		return 0;
+
+	if (pEntityOutput == NULL)
+		return -1;
+
+	OutputThrottle::Entry *pEntry = g_OutputThrottle.Find(pEntityOutput);
+	if (!pEntry || gamehelpers->ReferenceToEntity(pEntry->entref) != pEntity)
+		return -1;
+
+	return pEntry->suppressed;
+}
+
+const sp_nativeinfo_t g_ThrottleNatives[] =
+{
+	{ "SetOutputThrottle",				SetOutputThrottle<ReadOutputByName> },
+	{ "RemoveOutputThrottle",			RemoveOutputThrottle<ReadOutputByName> },
+	{ "GetOutputThrottleSuppressed",	GetOutputThrottleSuppressed<ReadOutputByName> },
+	{ "OutputKey.SetThrottle",			SetOutputThrottle<ReadOutputByKey> },
+	{ "OutputKey.RemoveThrottle",		RemoveOutputThrottle<ReadOutputByKey> },
+	{ "OutputKey.GetThrottleSuppressed",	GetOutputThrottleSuppressed<ReadOutputByKey> },
+	{ NULL, NULL },
+};
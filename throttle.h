@@ -0,0 +1,121 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Sample Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_OUTPUTINFO_THROTTLE_H_
+#define _INCLUDE_OUTPUTINFO_THROTTLE_H_
+
+/**
+ * @file throttle.h
+ * @brief Per-output fire rate limits, enforced in the FireOutput detour.
+ */
+
+#include "extension.h"
+#include "firehooks.h"
+#include <vector>
+
+class CBaseEntityOutput;
+
+enum OutputThrottleMode
+{
+	OutputThrottle_Drop = 0,		/**< Fires over the limit are dropped */
+	OutputThrottle_Coalesce,		/**< Fires over the limit become one fire when the window ends */
+};
+
+/**
+ * Throttled outputs are kept in a vector sorted by output address, so the
+ * fire path does a binary search over a few cache lines and never allocates.
+ * A window starts with the first fire after the previous one ended. Coalesced
+ * fires keep the arguments of the latest one and are fired again, through the
+ * plugin hooks but not the throttle, from the game frame hook or the next fire
+ * after the window ended, whichever comes first.
+ */
+class OutputThrottle
+{
+public:
+	struct Entry
+	{
+		CBaseEntityOutput *pOutput;
+		cell_t entref;
+		int maxFires;
+		float window;
+		OutputThrottleMode mode;
+		float windowStart;
+		int fires;
+		unsigned int suppressed;
+		bool pending;
+		FireOutputValue value;		/**< Latest coalesced fire */
+		cell_t activator;
+		cell_t caller;
+		float delay;
+	};
+
+	OutputThrottle() : m_NumPending(0) {}
+
+	void Init();
+	void Shutdown();
+	void Clear();
+
+	/**
+	 * @brief Adds or updates the throttle of an output; counters are kept on update.
+	 */
+	void Set(CBaseEntity *pEntity, CBaseEntityOutput *pOutput, int maxFires, float window, OutputThrottleMode mode);
+	bool Remove(CBaseEntityOutput *pOutput);
+	Entry *Find(CBaseEntityOutput *pOutput);
+
+	/**
+	 * @brief Called from the detour before anything else.
+	 *
+	 * @return				False to suppress the fire.
+	 */
+	bool OnFireOutput(CBaseEntityOutput *pOutput, const FireOutputValue &value, CBaseEntity *pActivator, CBaseEntity *pCaller, float flDelay);
+
+	/**
+	 * @brief Fires coalesced outputs whose window ended.
+	 */
+	void ProcessPending();
+
+	size_t Size() { return m_Entries.size(); }
+
+public:
+	std::vector<Entry> m_Entries;
+
+private:
+	bool IsLive(size_t index);
+	void Flush(size_t index);
+
+private:
+	int m_NumPending;
+};
+
+extern OutputThrottle g_OutputThrottle;
+extern const sp_nativeinfo_t g_ThrottleNatives[];
+
+#endif // _INCLUDE_OUTPUTINFO_THROTTLE_H_